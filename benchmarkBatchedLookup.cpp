@@ -0,0 +1,82 @@
+#include "unorderedSetHeader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Compares per-key count()/insert()/erase() against the batched, prefetching
+// find_many()/insert_range()/erase_many() on tables that fit in cache and on
+// tables larger than L3.
+//
+// Build: g++ -std=c++17 -O2 benchmarkBatchedLookup.cpp -o bench_batched
+// Usage: ./bench_batched [element_count ...]   (default: 1048576 16777216)
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_op(Clock::time_point start, Clock::time_point stop, std::size_t ops) {
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(ops);
+}
+
+static void run(std::size_t n) {
+    std::mt19937_64 rng(n);
+    std::vector<std::uint64_t> keys(n);
+    for (auto& k : keys)
+        k = rng();
+
+    // Half of the probes hit, half miss, in random order.
+    std::vector<std::uint64_t> probes(n);
+    for (std::size_t i = 0; i < n; ++i)
+        probes[i] = (i & 1) ? keys[rng() % n] : rng();
+    std::vector<std::uint64_t> bitmap((n + 63) / 64);
+
+    std::cout << "\nElements: " << n << std::endl;
+
+    auto t0 = Clock::now();
+    unordered_set<std::uint64_t> looped;
+    for (const auto& k : keys)
+        looped.insert(k);
+    auto t1 = Clock::now();
+    unordered_set<std::uint64_t> batched;
+    batched.insert_range(keys.begin(), keys.end());
+    auto t2 = Clock::now();
+    std::cout << "  insert loop:     " << ns_per_op(t0, t1, n) << " ns/key" << std::endl;
+    std::cout << "  insert_range:    " << ns_per_op(t1, t2, n) << " ns/key" << std::endl;
+
+    std::size_t hits = 0;
+    t0 = Clock::now();
+    for (const auto& k : probes)
+        hits += looped.count(k);
+    t1 = Clock::now();
+    std::size_t batched_hits = batched.find_many(probes.data(), probes.size(), bitmap.data());
+    t2 = Clock::now();
+    double per_key = ns_per_op(t0, t1, n);
+    double per_batch = ns_per_op(t1, t2, n);
+    std::cout << "  count loop:      " << per_key << " ns/key (" << hits << " hits)" << std::endl;
+    std::cout << "  find_many:       " << per_batch << " ns/key (" << batched_hits << " hits)" << std::endl;
+    std::cout << "  lookup speedup:  " << per_key / per_batch << "x" << std::endl;
+
+    std::size_t erased = 0;
+    t0 = Clock::now();
+    for (const auto& k : probes)
+        erased += looped.erase(k);
+    t1 = Clock::now();
+    std::size_t batched_erased = batched.erase_many(probes.data(), probes.size());
+    t2 = Clock::now();
+    std::cout << "  erase loop:      " << ns_per_op(t0, t1, n) << " ns/key (" << erased << " erased)" << std::endl;
+    std::cout << "  erase_many:      " << ns_per_op(t1, t2, n) << " ns/key (" << batched_erased << " erased)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back(static_cast<std::size_t>(std::strtoull(argv[i], nullptr, 10)));
+    if (sizes.empty())
+        sizes = { std::size_t(1) << 20, std::size_t(1) << 24 };
+
+    std::cout << "Batched lookup benchmark (unordered_set<std::uint64_t>)" << std::endl;
+    for (std::size_t n : sizes)
+        run(n);
+    return 0;
+}
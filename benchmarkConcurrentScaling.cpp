@@ -0,0 +1,102 @@
+#include "concurrentUnorderedSetHeader.hpp"
+#include "unorderedSetHeader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Measures throughput of a read-heavy mix (90% contains, 5% insert, 5% erase)
+// as the thread count grows, for concurrent_unordered_set and for the
+// single-mutex unordered_set it replaces.
+//
+// Build: g++ -std=c++17 -O2 -pthread benchmarkConcurrentScaling.cpp -o bench_concurrent
+// Usage: ./bench_concurrent [max_threads] [element_count] [ops_per_thread]
+//        (default: 32 1048576 2000000)
+
+using Clock = std::chrono::steady_clock;
+
+struct locked_set {
+    std::mutex mutex;
+    unordered_set<std::uint64_t> set;
+
+    bool insert(std::uint64_t k) { std::lock_guard<std::mutex> lock(mutex); return set.insert(k).second; }
+    std::size_t erase(std::uint64_t k) { std::lock_guard<std::mutex> lock(mutex); return set.erase(k); }
+    bool contains(std::uint64_t k) { std::lock_guard<std::mutex> lock(mutex); return set.contains(k); }
+};
+
+template<typename Set>
+static double run(Set& set, unsigned threads, std::uint64_t key_space, std::size_t ops) {
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::atomic<std::size_t> sink{ 0 };
+
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            std::size_t hits = 0;
+            ++ready;
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (std::size_t i = 0; i < ops; ++i) {
+                std::uint64_t r = rng();
+                std::uint64_t key = (r >> 8) % key_space;
+                unsigned op = static_cast<unsigned>(r % 100);
+                if (op < 90)
+                    hits += set.contains(key);
+                else if (op < 95)
+                    hits += set.insert(key);
+                else
+                    hits += set.erase(key);
+            }
+            sink += hits;
+        });
+    }
+    while (ready.load() != threads)
+        std::this_thread::yield();
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers)
+        w.join();
+    auto stop = Clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    return static_cast<double>(ops) * threads / seconds / 1e6;
+}
+
+int main(int argc, char** argv) {
+    unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 32;
+    std::uint64_t n = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (1u << 20);
+    std::size_t ops = argc > 3 ? static_cast<std::size_t>(std::strtoull(argv[3], nullptr, 10)) : 2000000;
+
+    std::cout << "Concurrent scaling benchmark: " << n << " keys, 90% contains / 5% insert / 5% erase, "
+              << ops << " ops per thread, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << "threads  concurrent Mops/s  (speedup)   single-mutex Mops/s  (speedup)" << std::endl;
+
+    double concurrent_base = 0, locked_base = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        concurrent_unordered_set<std::uint64_t> concurrent;
+        locked_set locked;
+        concurrent.reserve(n);
+        locked.set.reserve(n);
+        // Half of the key space is present, so lookups hit about half the time.
+        for (std::uint64_t k = 0; k < n; k += 2) {
+            concurrent.insert(k);
+            locked.set.insert(k);
+        }
+
+        double c = run(concurrent, threads, n, ops);
+        double l = run(locked, threads, n, ops);
+        if (threads == 1) {
+            concurrent_base = c;
+            locked_base = l;
+        }
+        std::cout << threads << "\t " << c << "\t\t(" << c / concurrent_base << "x)\t    "
+                  << l << "\t\t (" << l / locked_base << "x)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "unorderedSetHeader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+// Records the latency of every single insert while a table grows from empty,
+// once with the default all-at-once rehash and once with incremental
+// rehashing, and prints percentiles plus a log2 latency histogram.
+//
+// Build: g++ -std=c++17 -O2 benchmarkRehashLatency.cpp -o bench_rehash_latency
+// Usage: ./bench_rehash_latency [element_count]   (default: 4194304)
+
+using Clock = std::chrono::steady_clock;
+
+template<typename Set>
+static std::vector<std::uint64_t> measure(const std::vector<std::uint64_t>& keys) {
+    std::vector<std::uint64_t> latencies(keys.size());
+    Set set;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        auto start = Clock::now();
+        set.insert(keys[i]);
+        auto stop = Clock::now();
+        latencies[i] = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    }
+    return latencies;
+}
+
+static void report(const std::string& name, std::vector<std::uint64_t> latencies) {
+    std::vector<std::size_t> histogram(64, 0);
+    std::uint64_t total = 0;
+    for (std::uint64_t ns : latencies) {
+        unsigned bucket = 0;
+        while ((std::uint64_t(2) << bucket) <= ns && bucket < 63)
+            ++bucket;
+        ++histogram[bucket];
+        total += ns;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+    };
+
+    std::cout << "\n" << name << " (" << latencies.size() << " inserts, total "
+              << total / 1000000 << " ms)" << std::endl;
+    std::cout << "  mean " << total / latencies.size() << " ns, p50 " << percentile(0.50)
+              << " ns, p99 " << percentile(0.99) << " ns, p99.9 " << percentile(0.999)
+              << " ns, p99.99 " << percentile(0.9999) << " ns, max " << latencies.back() << " ns" << std::endl;
+    for (unsigned b = 0; b < histogram.size(); ++b) {
+        if (histogram[b] == 0)
+            continue;
+        std::cout << "  [" << std::setw(10) << (std::uint64_t(1) << b) << ", " << std::setw(10)
+                  << (std::uint64_t(2) << b) << ") ns: " << histogram[b] << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : (std::size_t(1) << 22);
+    std::mt19937_64 rng(7);
+    std::vector<std::uint64_t> keys(n);
+    for (auto& k : keys)
+        k = rng();
+
+    using eager_set = unordered_set<std::uint64_t>;
+    using incremental_set = unordered_set<std::uint64_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+                                          std::allocator<std::uint64_t>, unordered_set_traits<false, true>>;
+
+    std::cout << "Per-insert latency while growing to " << n << " elements" << std::endl;
+    report("Default rehash", measure<eager_set>(keys));
+    report("Incremental rehash", measure<incremental_set>(keys));
+    return 0;
+}
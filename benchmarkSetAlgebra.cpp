@@ -0,0 +1,111 @@
+#include "unorderedSetHeader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Compares combining two sets element by element through the public insert
+// API with the bulk operations: set_intersection / set_union /
+// set_difference at several thread counts, and merge versus re-inserting.
+//
+// Build: g++ -std=c++17 -O2 -pthread benchmarkSetAlgebra.cpp -o bench_set_algebra
+// Usage: ./bench_set_algebra [large_count] [small_count] [max_threads]
+//        (default: 8388608 4194304 hardware threads)
+
+using Clock = std::chrono::steady_clock;
+using id_set = unordered_set<std::uint64_t>;
+
+template<typename F>
+static double time_ms(F&& f) {
+    auto start = Clock::now();
+    f();
+    auto stop = Clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::size_t large_count = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : (std::size_t(1) << 23);
+    std::size_t small_count = argc > 2 ? static_cast<std::size_t>(std::strtoull(argv[2], nullptr, 10)) : (std::size_t(1) << 22);
+    unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+
+    // IDs are drawn from a range twice the size of the large set, so about
+    // half of the small set is also in the large one.
+    std::mt19937_64 rng(11);
+    std::uint64_t id_range = 2 * large_count;
+    id_set large, small;
+    large.reserve(large_count);
+    small.reserve(small_count);
+    while (large.size() < large_count)
+        large.insert(rng() % id_range);
+    while (small.size() < small_count)
+        small.insert(rng() % id_range);
+
+    std::cout << "Set algebra benchmark: " << large.size() << " and " << small.size() << " IDs, "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    std::size_t sink = 0;
+    double naive = time_ms([&] {
+        id_set result;
+        for (std::uint64_t id : small)
+            if (large.contains(id))
+                result.insert(id);
+        sink += result.size();
+    });
+    std::cout << "intersection, contains + insert loop: " << naive << " ms" << std::endl;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double ms = time_ms([&] { sink += set_intersection(large, small, threads).size(); });
+        std::cout << "set_intersection, " << threads << " thread(s): " << ms << " ms (" << naive / ms << "x)" << std::endl;
+    }
+
+    naive = time_ms([&] {
+        id_set result(large);
+        for (std::uint64_t id : small)
+            result.insert(id);
+        sink += result.size();
+    });
+    std::cout << "union, copy + insert loop: " << naive << " ms" << std::endl;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double ms = time_ms([&] { sink += set_union(large, small, threads).size(); });
+        std::cout << "set_union, " << threads << " thread(s): " << ms << " ms (" << naive / ms << "x)" << std::endl;
+    }
+
+    naive = time_ms([&] {
+        id_set result;
+        for (std::uint64_t id : large)
+            if (!small.contains(id))
+                result.insert(id);
+        sink += result.size();
+    });
+    std::cout << "difference, contains + insert loop: " << naive << " ms" << std::endl;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double ms = time_ms([&] { sink += set_difference(large, small, threads).size(); });
+        std::cout << "set_difference, " << threads << " thread(s): " << ms << " ms (" << naive / ms << "x)" << std::endl;
+    }
+
+    // merge consumes its source, so each variant gets fresh copies; only the
+    // combining step is timed.
+    {
+        id_set target(large), source(small);
+        double ms = time_ms([&] {
+            for (std::uint64_t id : source)
+                target.insert(id);
+            source.clear();
+        });
+        std::cout << "merge, insert loop + clear: " << ms << " ms" << std::endl;
+        sink += target.size();
+    }
+    {
+        id_set target(large), source(small);
+        double ms = time_ms([&] { target.merge(source); });
+        std::cout << "merge (node relinking): " << ms << " ms" << std::endl;
+        sink += target.size();
+    }
+
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "frozenUnorderedSetHeader.hpp"
+#include "unorderedSetHeader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Compares the ways a service can get a large set at startup: rebuilding it
+// with insert, load() from a snapshot, and mapping the snapshot as a
+// frozen_unordered_set. Each is followed by the same batch of lookups, so
+// the cost of faulting in a lazily mapped file is included.
+//
+// Build: g++ -std=c++17 -O2 benchmarkSnapshotLoad.cpp -o bench_snapshot
+// Usage: ./bench_snapshot [element_count] [snapshot_path]
+//        (default: 8388608 /tmp/unordered_set_bench.snap)
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+static double time_ms(F&& f) {
+    auto start = Clock::now();
+    f();
+    auto stop = Clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+template<typename Set>
+static std::size_t probe(const Set& set, const std::vector<std::uint64_t>& queries) {
+    std::size_t hits = 0;
+    for (std::uint64_t q : queries)
+        hits += set.count(q);
+    return hits;
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : (std::size_t(1) << 23);
+    std::string path = argc > 2 ? argv[2] : "/tmp/unordered_set_bench.snap";
+
+    std::mt19937_64 rng(17);
+    std::vector<std::uint64_t> source(n);
+    for (auto& k : source)
+        k = rng();
+    std::vector<std::uint64_t> queries(1000000);
+    for (std::size_t i = 0; i < queries.size(); ++i)
+        queries[i] = i % 2 ? source[rng() % n] : rng();
+
+    std::cout << "Startup benchmark: " << n << " keys, " << queries.size() << " lookups after loading" << std::endl;
+    std::size_t sink = 0;
+
+    {
+        unordered_set<std::uint64_t> built;
+        double ms = time_ms([&] {
+            for (std::uint64_t k : source)
+                built.insert(k);
+        });
+        double save_ms = time_ms([&] { built.save(path); });
+        double probe_ms = time_ms([&] { sink += probe(built, queries); });
+        std::cout << "rebuild with insert: " << ms << " ms, lookups " << probe_ms << " ms (save took "
+                  << save_ms << " ms)" << std::endl;
+    }
+    {
+        unordered_set<std::uint64_t> loaded;
+        double ms = time_ms([&] { loaded.load(path); });
+        double probe_ms = time_ms([&] { sink += probe(loaded, queries); });
+        std::cout << "load():              " << ms << " ms, lookups " << probe_ms << " ms" << std::endl;
+    }
+    {
+        frozen_unordered_set<std::uint64_t> frozen;
+        double ms = time_ms([&] { frozen.open(path); });
+        double probe_ms = time_ms([&] { sink += probe(frozen, queries); });
+        std::cout << "frozen open():       " << ms << " ms, lookups " << probe_ms << " ms" << std::endl;
+    }
+
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
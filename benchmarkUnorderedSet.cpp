@@ -0,0 +1,354 @@
+#include "unorderedSetHeader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Benchmark suite comparing unordered_set with std::unordered_set on the
+// workloads our services run: inserts with and without reserve, hit and miss
+// lookups, erase-heavy churn, full iteration, copy and move, for int,
+// uint64 and string keys. Results go to stdout as one JSON document, so runs
+// can be stored and diffed across versions; progress goes to stderr.
+//
+// Every result reports ns/op, and the heap allocations and bytes the timed
+// code requested per repetition, counted by replacing the global operator
+// new. Insert results also report the memory held by the finished container.
+//
+// Build: cmake -S . -B build && cmake --build build --target bench_unordered_set
+// Usage: ./bench_unordered_set [--sizes=1000,100000,...] [--keys=int,uint64,string]
+//                              [--min-ops=N]
+//        (default sizes 1000,10000,100000,1000000; up to 100000000 on request)
+
+/********************************************************************************
+ * Allocation accounting
+ * ------------------------------------------------------------------------------
+ * Every operator new call is counted, and its size is stored in a small
+ * header so that operator delete can keep the live byte count exact. The
+ * benchmark is single-threaded, so plain counters are enough. The operators
+ * are kept out of line so the compiler does not pair the header arithmetic
+ * with the caller's view of the allocation.
+ ********************************************************************************/
+namespace {
+
+struct alloc_counters {
+    std::size_t allocations = 0;
+    std::size_t allocated_bytes = 0;
+    std::size_t live_bytes = 0;
+};
+
+alloc_counters counters;
+constexpr std::size_t kAllocHeader = alignof(std::max_align_t);
+
+} // namespace
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(std::size_t size) {
+    void* p = std::malloc(size + kAllocHeader);
+    if (!p)
+        throw std::bad_alloc();
+    *static_cast<std::size_t*>(p) = size;
+    ++counters.allocations;
+    counters.allocated_bytes += size;
+    counters.live_bytes += size;
+    return static_cast<char*>(p) + kAllocHeader;
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept {
+    if (!p)
+        return;
+    void* base = static_cast<char*>(p) - kAllocHeader;
+    counters.live_bytes -= *static_cast<std::size_t*>(base);
+    std::free(base);
+}
+
+BENCH_NOINLINE void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/********************************************************************************
+ * Keys
+ * ------------------------------------------------------------------------------
+ * Key i is a bijective scramble of i, so keys are distinct, spread over the
+ * whole key space, and key n + i is a guaranteed miss for a set of the first n.
+ * String keys are long enough to defeat the small-string buffer, like the
+ * IDs they stand for.
+ ********************************************************************************/
+std::uint64_t scramble(std::uint64_t x) {
+    x ^= x >> 31;
+    x *= 0x7fb5d329728ea185ULL;
+    x ^= x >> 27;
+    x *= 0x81dadef4bc2dd44dULL;
+    x ^= x >> 33;
+    return x;
+}
+
+template<typename Key>
+Key make_key(std::uint64_t i);
+
+template<>
+int make_key<int>(std::uint64_t i) {
+    // Odd multiplier: a bijection on 32-bit values.
+    return static_cast<int>(static_cast<std::uint32_t>(i) * 2654435761u);
+}
+
+template<>
+std::uint64_t make_key<std::uint64_t>(std::uint64_t i) {
+    return scramble(i);
+}
+
+template<>
+std::string make_key<std::string>(std::uint64_t i) {
+    return "user:" + std::to_string(scramble(i));
+}
+
+template<typename Key> const char* key_name();
+template<> const char* key_name<int>() { return "int"; }
+template<> const char* key_name<std::uint64_t>() { return "uint64"; }
+template<> const char* key_name<std::string>() { return "string"; }
+
+template<typename Key>
+std::size_t touch(const Key& key) {
+    return static_cast<std::size_t>(key);
+}
+
+template<>
+std::size_t touch<std::string>(const std::string& key) {
+    return key.size();
+}
+
+/********************************************************************************
+ * Results
+ ********************************************************************************/
+struct result {
+    std::string container;
+    std::string key;
+    std::size_t size;
+    std::string workload;
+    std::size_t ops;
+    double ns_per_op;
+    double allocations;
+    double allocated_bytes;
+    std::size_t memory_bytes;
+};
+
+std::vector<result> results;
+std::size_t sink = 0;
+std::size_t min_ops = 2000000;
+
+// Runs body until about min_ops elements have been processed, where body
+// returns the number of operations it did, and records the averages. Setup
+// before each repetition is not timed.
+template<typename Setup, typename Body>
+void measure(const char* container, const char* key, std::size_t n, const char* workload,
+             std::size_t elements_per_rep, Setup&& setup, Body&& body, std::size_t memory_bytes = 0) {
+    std::size_t reps = std::max<std::size_t>(1, min_ops / std::max<std::size_t>(1, elements_per_rep));
+    double total_ns = 0;
+    std::size_t allocations = 0, allocated_bytes = 0, ops = 0;
+    for (std::size_t r = 0; r < reps; ++r) {
+        auto state = setup();
+        std::size_t a0 = counters.allocations, b0 = counters.allocated_bytes;
+        auto start = Clock::now();
+        ops += body(state);
+        auto stop = Clock::now();
+        allocations += counters.allocations - a0;
+        allocated_bytes += counters.allocated_bytes - b0;
+        total_ns += std::chrono::duration<double, std::nano>(stop - start).count();
+    }
+    results.push_back({ container, key, n, workload, ops, total_ns / static_cast<double>(ops),
+                        static_cast<double>(allocations) / reps, static_cast<double>(allocated_bytes) / reps,
+                        memory_bytes });
+    std::cerr << "  " << container << " " << key << " n=" << n << " " << workload << ": "
+              << results.back().ns_per_op << " ns/op" << std::endl;
+}
+
+struct none {};
+
+/********************************************************************************
+ * run_workloads
+ * ------------------------------------------------------------------------------
+ * Runs every workload for one container, key type and size. keys holds the
+ * n present keys followed by n absent ones.
+ ********************************************************************************/
+template<typename Set>
+void run_workloads(const char* container, const std::vector<typename Set::key_type>& keys, std::size_t n) {
+    using Key = typename Set::key_type;
+    const char* key = key_name<Key>();
+    auto no_setup = [] { return none{}; };
+
+    // Footprint of a set grown by plain inserts, counted once up front.
+    std::size_t memory_bytes = 0;
+    {
+        std::size_t before = counters.live_bytes;
+        Set set;
+        for (std::size_t i = 0; i < n; ++i)
+            set.insert(keys[i]);
+        memory_bytes = counters.live_bytes - before;
+    }
+
+    measure(container, key, n, "insert", n, [] { return std::make_unique<Set>(); },
+            [&](std::unique_ptr<Set>& set) {
+                for (std::size_t i = 0; i < n; ++i)
+                    set->insert(keys[i]);
+                return n;
+            }, memory_bytes);
+
+    measure(container, key, n, "insert_reserved", n, [] { return std::make_unique<Set>(); },
+            [&](std::unique_ptr<Set>& set) {
+                set->reserve(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    set->insert(keys[i]);
+                return n;
+            });
+
+    Set set;
+    for (std::size_t i = 0; i < n; ++i)
+        set.insert(keys[i]);
+
+    measure(container, key, n, "find_hit", n, no_setup, [&](none&) {
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            hits += set.find(keys[i]) != set.end();
+        sink += hits;
+        return n;
+    });
+
+    measure(container, key, n, "find_miss", n, no_setup, [&](none&) {
+        std::size_t hits = 0;
+        for (std::size_t i = n; i < 2 * n; ++i)
+            hits += set.find(keys[i]) != set.end();
+        sink += hits;
+        return n;
+    });
+
+    measure(container, key, n, "iterate", n, no_setup, [&](none&) {
+        std::size_t sum = 0;
+        for (const auto& k : set)
+            sum += touch(k);
+        sink += sum;
+        return n;
+    });
+
+    // Erase-heavy churn: every step erases one live key and inserts one new
+    // key, so the size stays at n while the whole key set is replaced.
+    measure(container, key, n, "erase_churn", 2 * n, [&] { return std::make_unique<Set>(set); },
+            [&](std::unique_ptr<Set>& churned) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    churned->erase(keys[i]);
+                    churned->insert(keys[n + i]);
+                }
+                return 2 * n;
+            });
+
+    measure(container, key, n, "copy", n, [] { return std::make_unique<Set>(); },
+            [&](std::unique_ptr<Set>& copy) {
+                *copy = set;
+                return n;
+            });
+
+    // Both sets outlive the timed region, so only the move itself is measured.
+    using move_state = std::pair<Set, std::optional<Set>>;
+    measure(container, key, n, "move", n, [&] { return std::make_unique<move_state>(set, std::nullopt); },
+            [&](std::unique_ptr<move_state>& state) {
+                state->second.emplace(std::move(state->first));
+                sink += state->second->size();
+                return std::size_t(1);
+            });
+}
+
+template<typename Key>
+void run_key(std::size_t n) {
+    std::vector<Key> keys;
+    keys.reserve(2 * n);
+    for (std::size_t i = 0; i < 2 * n; ++i)
+        keys.push_back(make_key<Key>(i));
+    run_workloads<unordered_set<Key>>("unordered_set", keys, n);
+    run_workloads<std::unordered_set<Key>>("std::unordered_set", keys, n);
+}
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> parts;
+    std::stringstream in(list);
+    std::string part;
+    while (std::getline(in, part, ','))
+        if (!part.empty())
+            parts.push_back(part);
+    return parts;
+}
+
+void print_json() {
+    std::cout << "{\n  \"benchmark\": \"bench_unordered_set\",\n  \"format_version\": 1,\n  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const result& r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "%s\n    {\"container\": \"%s\", \"key\": \"%s\", \"size\": %zu, \"workload\": \"%s\", "
+                      "\"ops\": %zu, \"ns_per_op\": %.3f, \"allocations\": %.1f, \"allocated_bytes\": %.1f, "
+                      "\"memory_bytes\": %zu}",
+                      i ? "," : "", r.container.c_str(), r.key.c_str(), r.size, r.workload.c_str(), r.ops,
+                      r.ns_per_op, r.allocations, r.allocated_bytes, r.memory_bytes);
+        std::cout << line;
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    std::vector<std::string> key_types = { "int", "uint64", "string" };
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--sizes=", 0) == 0) {
+            sizes.clear();
+            for (const auto& s : split(arg.substr(8)))
+                sizes.push_back(static_cast<std::size_t>(std::strtoull(s.c_str(), nullptr, 10)));
+        }
+        else if (arg.rfind("--keys=", 0) == 0) {
+            key_types = split(arg.substr(7));
+        }
+        else if (arg.rfind("--min-ops=", 0) == 0) {
+            min_ops = static_cast<std::size_t>(std::strtoull(arg.c_str() + 10, nullptr, 10));
+        }
+        else {
+            std::cerr << "usage: " << argv[0] << " [--sizes=N,...] [--keys=int,uint64,string] [--min-ops=N]" << std::endl;
+            return 2;
+        }
+    }
+
+    for (std::size_t n : sizes) {
+        for (const auto& k : key_types) {
+            std::cerr << "key " << k << ", n = " << n << std::endl;
+            if (k == "int")
+                run_key<int>(n);
+            else if (k == "uint64")
+                run_key<std::uint64_t>(n);
+            else if (k == "string")
+                run_key<std::string>(n);
+            else
+                std::cerr << "  unknown key type " << k << ", skipped" << std::endl;
+        }
+    }
+    print_json();
+    std::cerr << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,173 @@
+#ifndef CONCURRENT_UNORDERED_SET_HPP
+#define CONCURRENT_UNORDERED_SET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "epochReclamation.hpp"
+#include "nodePool.hpp"
+#include "unorderedSetDetail.hpp"
+
+/********************************************************************************
+ * concurrent_unordered_set
+ * ------------------------------------------------------------------------------
+ * Thread-safe companion of unordered_set built from the same chained nodes and
+ * power-of-two bucket arrays. The table is split into shards selected by the
+ * high half of the hash; each shard has its own mutex, node pool and bucket
+ * array, so writers on different shards never contend and a resize only
+ * affects the shard that outgrew its buckets.
+ *
+ * Lookups take no lock. Nodes are published with release stores, erased nodes
+ * are unlinked but only freed through epoch-based reclamation, and a shard's
+ * version counter is odd while a resize relinks its nodes. A lookup that
+ * misses while the version changed under it simply retries.
+ *
+ * There are no iterators: an element may be erased the moment it is found.
+ * visit() and for_each() hand elements to a callback instead. Neither holds a
+ * shard lock while the callback runs, so the callback may use the set too.
+ ********************************************************************************/
+template<
+    typename Key,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Allocator = std::allocator<Key>
+>
+class concurrent_unordered_set {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    static constexpr size_type kDefaultShardCount = 64;
+
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        size_type hash;
+        value_type value;
+        template<typename... Args>
+        explicit Node(std::in_place_t, Args&&... args) : next(nullptr), hash(0), value(std::forward<Args>(args)...) {}
+    };
+
+    struct bucket_table {
+        size_type mask;
+        std::atomic<Node*>* buckets;
+    };
+
+    struct retired_node {
+        Node* node;
+        std::uint64_t epoch;
+    };
+
+    struct retired_table {
+        bucket_table* table;
+        std::uint64_t epoch;
+    };
+
+    using node_pool_type = unordered_set_detail::node_pool<Node, Allocator>;
+
+    // Lock-free readers only touch the first cache line; writers the second.
+    struct alignas(unordered_set_detail::kCacheLineSize) shard {
+        std::atomic<bucket_table*> table;
+        std::atomic<std::uint64_t> version;
+        alignas(unordered_set_detail::kCacheLineSize) std::mutex mutex;
+        std::atomic<size_type> count;
+        node_pool_type pool;
+        std::vector<retired_node> retired_nodes;
+        std::vector<retired_table> retired_tables;
+
+        explicit shard(const Allocator& alloc) : table(nullptr), version(0), count(0), pool(alloc) {}
+    };
+
+    using shard_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<shard>;
+    using table_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<bucket_table>;
+    using bucket_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<Node*>>;
+
+    static constexpr size_type kRetireThreshold = 64;
+    static constexpr size_type kMinShardBuckets = 8;
+
+    shard* shards;
+    size_type shard_count_;
+    std::atomic<float> max_load_factor_;
+    hasher hash_func;
+    key_equal key_eq;
+    Allocator alloc;
+
+    void release_shards(size_type constructed);
+
+    size_type hash_of(const key_type& key) const;
+    shard& shard_for(size_type hash) const;
+
+    bucket_table* allocate_table(size_type bucket_count);
+    void deallocate_table(bucket_table* table);
+
+    template<typename... Args>
+    Node* create_node(shard& s, Args&&... args);
+    void destroy_node(shard& s, Node* node);
+
+    const Node* find_node(const key_type& key, size_type hash) const;
+    std::atomic<Node*>* find_link(shard& s, const key_type& key, size_type hash) const;
+    template<typename V>
+    bool insert_value(V&& value);
+
+    void retire(shard& s, Node* node);
+    void retire(shard& s, bucket_table* table);
+    void reclaim(shard& s);
+
+    void grow_if_needed(shard& s);
+    void rehash_shard(shard& s, size_type new_bucket_count);
+
+public:
+    concurrent_unordered_set();
+    explicit concurrent_unordered_set(size_type bucket_count_, size_type shard_count = kDefaultShardCount, const hasher& hash_func_ = hasher(), const key_equal& equal = key_equal(), const allocator_type& alloc_ = allocator_type());
+    concurrent_unordered_set(std::initializer_list<value_type> init, size_type bucket_count_ = 0, size_type shard_count = kDefaultShardCount, const hasher& hash_func_ = hasher(), const key_equal& equal = key_equal(), const allocator_type& alloc_ = allocator_type());
+    concurrent_unordered_set(const concurrent_unordered_set&) = delete;
+    concurrent_unordered_set& operator=(const concurrent_unordered_set&) = delete;
+    ~concurrent_unordered_set();
+
+    allocator_type get_allocator() const;
+
+    bool empty() const;
+    size_type size() const;
+    size_type bucket_count() const;
+    size_type shard_count() const;
+    float load_factor() const;
+    float max_load_factor() const;
+    void max_load_factor(float ml);
+
+    void clear();
+    bool insert(const value_type& value);
+    bool insert(value_type&& value);
+    template<typename... Args>
+    bool emplace(Args&&... args);
+
+    size_type erase(const key_type& key);
+
+    size_type count(const key_type& key) const;
+    bool contains(const key_type& key) const;
+    template<typename F>
+    bool visit(const key_type& key, F&& f) const;
+    template<typename F>
+    void for_each(F&& f) const;
+
+    void rehash(size_type new_bucket_count);
+    void reserve(size_type count);
+};
+
+#include "concurrentUnorderedSetImplementation.tpp"
+
+#endif
@@ -0,0 +1,890 @@
+#include "concurrentUnorderedSetHeader.hpp"
+
+/********************************************************************************
+ * release_shards
+ * ------------------------------------------------------------------------------
+ * Destroys every element, retired node and bucket table of the first
+ * `constructed` shards, destroys those shards and frees the shard array. Used
+ * by the destructor and to unwind a constructor that threw part way through.
+ * No other thread may be using the container.
+ *
+ * Parameters:
+ *   - constructed: Number of shards that were constructed.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::release_shards(size_type constructed) {
+    for (size_type i = 0; i < constructed; ++i) {
+        shard& s = shards[i];
+        if (bucket_table* table = s.table.load(std::memory_order_relaxed)) {
+            for (size_type b = 0; b <= table->mask; ++b) {
+                Node* current = table->buckets[b].load(std::memory_order_relaxed);
+                while (current) {
+                    Node* next = current->next.load(std::memory_order_relaxed);
+                    destroy_node(s, current);
+                    current = next;
+                }
+            }
+            deallocate_table(table);
+        }
+        for (const retired_node& r : s.retired_nodes)
+            destroy_node(s, r.node);
+        for (const retired_table& r : s.retired_tables)
+            deallocate_table(r.table);
+        s.~shard();
+    }
+    shard_allocator_type shard_alloc(alloc);
+    std::allocator_traits<shard_allocator_type>::deallocate(shard_alloc, shards, shard_count_);
+    shards = nullptr;
+}
+
+/********************************************************************************
+ * hash_of
+ * ------------------------------------------------------------------------------
+ * Hashes a key with the user's hasher and post-mixes the result. The high half
+ * of the mixed hash picks the shard and the low bits pick the bucket inside it.
+ *
+ * Parameters:
+ *   - key: The key to hash.
+ *
+ * Returns:
+ *   - The mixed hash value.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::hash_of(const key_type& key) const {
+    return unordered_set_detail::mix_hash(hash_func(key));
+}
+
+/********************************************************************************
+ * shard_for
+ * ------------------------------------------------------------------------------
+ * Selects the shard that owns a hash.
+ *
+ * Parameters:
+ *   - hash: A mixed hash value.
+ *
+ * Returns:
+ *   - Reference to the owning shard.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::shard&
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::shard_for(size_type hash) const {
+    return shards[(hash >> (sizeof(size_type) * 4)) & (shard_count_ - 1)];
+}
+
+/********************************************************************************
+ * allocate_table
+ * ------------------------------------------------------------------------------
+ * Allocates a bucket table with all buckets empty. Both the table header and
+ * the bucket array come from the container's allocator.
+ *
+ * Parameters:
+ *   - bucket_count: Number of buckets; must be a power of two.
+ *
+ * Returns:
+ *   - Pointer to the new table.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::bucket_table*
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::allocate_table(size_type bucket_count) {
+    using table_traits = std::allocator_traits<table_allocator_type>;
+    using bucket_traits = std::allocator_traits<bucket_allocator_type>;
+    table_allocator_type table_alloc(alloc);
+    bucket_allocator_type bucket_alloc(alloc);
+
+    bucket_table* table = table_traits::allocate(table_alloc, 1);
+    std::atomic<Node*>* buckets;
+    try {
+        buckets = bucket_traits::allocate(bucket_alloc, bucket_count);
+    }
+    catch (...) {
+        table_traits::deallocate(table_alloc, table, 1);
+        throw;
+    }
+    for (size_type i = 0; i < bucket_count; ++i)
+        ::new (static_cast<void*>(buckets + i)) std::atomic<Node*>(nullptr);
+    return ::new (static_cast<void*>(table)) bucket_table{ bucket_count - 1, buckets };
+}
+
+/********************************************************************************
+ * deallocate_table
+ * ------------------------------------------------------------------------------
+ * Frees a bucket table. The nodes it points to are left alone.
+ *
+ * Parameters:
+ *   - table: The table to free.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::deallocate_table(bucket_table* table) {
+    table_allocator_type table_alloc(alloc);
+    bucket_allocator_type bucket_alloc(alloc);
+    std::allocator_traits<bucket_allocator_type>::deallocate(bucket_alloc, table->buckets, table->mask + 1);
+    std::allocator_traits<table_allocator_type>::deallocate(table_alloc, table, 1);
+}
+
+/********************************************************************************
+ * create_node
+ * ------------------------------------------------------------------------------
+ * Creates a node in the given shard's pool with its value constructed in
+ * place from args. The shard's mutex must be held.
+ *
+ * Parameters:
+ *   - s: The shard that will own the node.
+ *   - args: Arguments forwarded to the value_type constructor.
+ *
+ * Returns:
+ *   - Pointer to the newly created Node.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename... Args>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::Node*
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::create_node(shard& s, Args&&... args) {
+    Node* node = s.pool.allocate();
+    try {
+        ::new (static_cast<void*>(node)) Node(std::in_place, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        s.pool.deallocate(node);
+        throw;
+    }
+    return node;
+}
+
+/********************************************************************************
+ * destroy_node
+ * ------------------------------------------------------------------------------
+ * Destroys a node and returns its storage to the shard's pool. The shard's
+ * mutex must be held and no reader may still reach the node.
+ *
+ * Parameters:
+ *   - s: The shard that owns the node.
+ *   - node: Pointer to the node to destroy.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::destroy_node(shard& s, Node* node) {
+    node->~Node();
+    s.pool.deallocate(node);
+}
+
+/********************************************************************************
+ * find_node
+ * ------------------------------------------------------------------------------
+ * Lock-free lookup. Walks the key's chain using acquire loads, so a node
+ * published by insert is seen fully constructed. Erase never changes the
+ * next pointer of the node it unlinks, so a reader standing on it still
+ * reaches the rest of the chain. A resize does move nodes between chains;
+ * a miss is therefore only trusted if the shard's version was even and
+ * unchanged for the whole walk, and retried otherwise.
+ *
+ * The caller must hold an epoch_guard for as long as it uses the result.
+ *
+ * Parameters:
+ *   - key: The key to look for.
+ *   - hash: The mixed hash of key.
+ *
+ * Returns:
+ *   - Pointer to the matching node, or nullptr if the key is absent.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+const typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::Node*
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::find_node(const key_type& key, size_type hash) const {
+    const shard& s = shard_for(hash);
+    for (;;) {
+        std::uint64_t version = s.version.load(std::memory_order_acquire);
+        if ((version & 1) == 0) {
+            const bucket_table* table = s.table.load(std::memory_order_acquire);
+            const Node* current = table->buckets[hash & table->mask].load(std::memory_order_acquire);
+            for (; current; current = current->next.load(std::memory_order_acquire)) {
+                if (current->hash == hash && key_eq(current->value, key))
+                    return current;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.version.load(std::memory_order_relaxed) == version)
+                return nullptr;
+        }
+        std::this_thread::yield();
+    }
+}
+
+/********************************************************************************
+ * find_link
+ * ------------------------------------------------------------------------------
+ * Finds the link (bucket head or a node's next pointer) that points at the
+ * node holding key. The shard's mutex must be held.
+ *
+ * Parameters:
+ *   - s: The shard owning hash.
+ *   - key: The key to look for.
+ *   - hash: The mixed hash of key.
+ *
+ * Returns:
+ *   - The link pointing at the matching node, or nullptr if the key is absent.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+std::atomic<typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::Node*>*
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::find_link(shard& s, const key_type& key, size_type hash) const {
+    bucket_table* table = s.table.load(std::memory_order_relaxed);
+    std::atomic<Node*>* link = &table->buckets[hash & table->mask];
+    for (Node* current = link->load(std::memory_order_relaxed); current; current = link->load(std::memory_order_relaxed)) {
+        if (current->hash == hash && key_eq(current->value, key))
+            return link;
+        link = &current->next;
+    }
+    return nullptr;
+}
+
+/********************************************************************************
+ * insert_value
+ * ------------------------------------------------------------------------------
+ * Inserts value under its shard's mutex unless an equal key is present. The
+ * shard grows first if needed, then the new node is published at the head of
+ * its chain with a release store.
+ *
+ * Parameters:
+ *   - value: The value to copy or move into the set.
+ *
+ * Returns:
+ *   - true if the value was inserted, false if the key already existed.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename V>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::insert_value(V&& value) {
+    size_type hash = hash_of(value);
+    shard& s = shard_for(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (find_link(s, value, hash))
+        return false;
+    grow_if_needed(s);
+
+    Node* node = create_node(s, std::forward<V>(value));
+    node->hash = hash;
+    bucket_table* table = s.table.load(std::memory_order_relaxed);
+    std::atomic<Node*>& head = table->buckets[hash & table->mask];
+    node->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    head.store(node, std::memory_order_release);
+    s.count.store(s.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+/********************************************************************************
+ * retire (node)
+ * ------------------------------------------------------------------------------
+ * Queues an unlinked node for destruction once no reader can reach it, and
+ * periodically frees whatever has become safe. The shard's mutex must be held.
+ *
+ * Parameters:
+ *   - s: The shard that owns the node.
+ *   - node: The node that was just unlinked.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::retire(shard& s, Node* node) {
+    s.retired_nodes.push_back({ node, unordered_set_detail::epoch_domain::instance().current() });
+    if (s.retired_nodes.size() % kRetireThreshold == 0)
+        reclaim(s);
+}
+
+/********************************************************************************
+ * retire (table)
+ * ------------------------------------------------------------------------------
+ * Queues a bucket table replaced by a resize for deallocation once no reader
+ * can still be walking it. The shard's mutex must be held.
+ *
+ * Parameters:
+ *   - s: The shard that owned the table.
+ *   - table: The replaced table.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::retire(shard& s, bucket_table* table) {
+    s.retired_tables.push_back({ table, unordered_set_detail::epoch_domain::instance().current() });
+    reclaim(s);
+}
+
+/********************************************************************************
+ * reclaim
+ * ------------------------------------------------------------------------------
+ * Tries to advance the global epoch and frees every retired node and table of
+ * the shard that no pinned reader can still reach. The shard's mutex must be
+ * held.
+ *
+ * Parameters:
+ *   - s: The shard to reclaim from.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::reclaim(shard& s) {
+    using unordered_set_detail::epoch_domain;
+    std::uint64_t now = epoch_domain::instance().try_advance();
+
+    size_type kept = 0;
+    for (const retired_node& r : s.retired_nodes) {
+        if (epoch_domain::is_safe(r.epoch, now))
+            destroy_node(s, r.node);
+        else
+            s.retired_nodes[kept++] = r;
+    }
+    s.retired_nodes.resize(kept);
+
+    kept = 0;
+    for (const retired_table& r : s.retired_tables) {
+        if (epoch_domain::is_safe(r.epoch, now))
+            deallocate_table(r.table);
+        else
+            s.retired_tables[kept++] = r;
+    }
+    s.retired_tables.resize(kept);
+}
+
+/********************************************************************************
+ * grow_if_needed
+ * ------------------------------------------------------------------------------
+ * Doubles the shard's bucket count if one more element would push it past the
+ * maximum load factor. The shard's mutex must be held.
+ *
+ * Parameters:
+ *   - s: The shard about to receive an element.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::grow_if_needed(shard& s) {
+    size_type buckets = s.table.load(std::memory_order_relaxed)->mask + 1;
+    float limit = static_cast<float>(buckets) * max_load_factor_.load(std::memory_order_relaxed);
+    if (static_cast<float>(s.count.load(std::memory_order_relaxed) + 1) > limit)
+        rehash_shard(s, buckets * 2);
+}
+
+/********************************************************************************
+ * rehash_shard
+ * ------------------------------------------------------------------------------
+ * Moves one shard's nodes into a larger bucket table. Only this shard's
+ * writers wait; readers keep running. The version is odd while nodes are
+ * being relinked, which makes concurrent misses retry, and the old table is
+ * retired rather than freed. The node hash is cached, so the user's hasher
+ * is never called here. The shard's mutex must be held.
+ *
+ * Parameters:
+ *   - s: The shard to resize.
+ *   - new_bucket_count: Requested bucket count, rounded up to a power of two.
+ *     Requests that would not grow the table are ignored.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::rehash_shard(shard& s, size_type new_bucket_count) {
+    bucket_table* old_table = s.table.load(std::memory_order_relaxed);
+    new_bucket_count = unordered_set_detail::next_power_of_two(new_bucket_count);
+    if (new_bucket_count <= old_table->mask + 1)
+        return;
+    bucket_table* new_table = allocate_table(new_bucket_count);
+
+    std::uint64_t version = s.version.load(std::memory_order_relaxed);
+    s.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_type i = 0; i <= old_table->mask; ++i) {
+        Node* current = old_table->buckets[i].load(std::memory_order_relaxed);
+        while (current) {
+            Node* next = current->next.load(std::memory_order_relaxed);
+            std::atomic<Node*>& head = new_table->buckets[current->hash & new_table->mask];
+            current->next.store(head.load(std::memory_order_relaxed), std::memory_order_release);
+            head.store(current, std::memory_order_release);
+            current = next;
+        }
+    }
+
+    s.table.store(new_table, std::memory_order_release);
+    s.version.store(version + 2, std::memory_order_release);
+    retire(s, old_table);
+}
+
+/********************************************************************************
+ * Default Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs an empty concurrent_unordered_set with kDefaultShardCount shards
+ * of kMinShardBuckets buckets each and a max load factor of 1.0.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::concurrent_unordered_set()
+    : concurrent_unordered_set(0)
+{
+}
+
+/********************************************************************************
+ * Constructor with bucket_count_
+ * ------------------------------------------------------------------------------
+ * Constructs a concurrent_unordered_set whose buckets are spread evenly over
+ * the shards. Both counts are rounded up to powers of two. More shards mean
+ * less writer contention at the cost of a little memory per shard.
+ *
+ * Parameters:
+ *   - bucket_count_: Initial total number of buckets.
+ *   - shard_count: Number of independently locked shards.
+ *   - hash_func_: Hash function for keys.
+ *   - equal: Equality function for keys.
+ *   - alloc_: Allocator to use.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::concurrent_unordered_set(size_type bucket_count_,
+                                                                               size_type shard_count,
+                                                                               const hasher& hash_func_,
+                                                                               const key_equal& equal,
+                                                                               const allocator_type& alloc_)
+    : shards(nullptr), shard_count_(unordered_set_detail::next_power_of_two(shard_count)), max_load_factor_(1.0f),
+      hash_func(hash_func_), key_eq(equal), alloc(alloc_)
+{
+    size_type per_shard = unordered_set_detail::next_power_of_two(
+        std::max(kMinShardBuckets, (bucket_count_ + shard_count_ - 1) / shard_count_));
+
+    shard_allocator_type shard_alloc(alloc);
+    shards = std::allocator_traits<shard_allocator_type>::allocate(shard_alloc, shard_count_);
+    size_type constructed = 0;
+    try {
+        while (constructed < shard_count_) {
+            shard* s = ::new (static_cast<void*>(shards + constructed)) shard(alloc);
+            ++constructed;
+            s->table.store(allocate_table(per_shard), std::memory_order_relaxed);
+        }
+    }
+    catch (...) {
+        release_shards(constructed);
+        throw;
+    }
+}
+
+/********************************************************************************
+ * Initializer List Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs a concurrent_unordered_set holding the values of an
+ * initializer_list.
+ *
+ * Parameters:
+ *   - init: Initializer list of values.
+ *   - bucket_count_: Initial total bucket count (optional).
+ *   - shard_count: Number of shards (optional).
+ *   - hash_func_: Hash function.
+ *   - equal: Equality function.
+ *   - alloc_: Allocator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::concurrent_unordered_set(
+    std::initializer_list<value_type> init,
+    size_type bucket_count_,
+    size_type shard_count,
+    const hasher& hash_func_,
+    const key_equal& equal,
+    const allocator_type& alloc_)
+    : concurrent_unordered_set(bucket_count_ ? bucket_count_ : init.size(), shard_count, hash_func_, equal, alloc_)
+{
+    for (const auto& val : init) {
+        insert(val);
+    }
+}
+
+/********************************************************************************
+ * Destructor
+ * ------------------------------------------------------------------------------
+ * Destroys every element, including erased ones still awaiting reclamation,
+ * and frees all memory. No other thread may be using the container.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::~concurrent_unordered_set() {
+    release_shards(shard_count_);
+}
+
+/********************************************************************************
+ * get_allocator
+ * ------------------------------------------------------------------------------
+ * Returns a copy of the allocator the container was constructed with.
+ *
+ * Returns:
+ *   - The allocator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::allocator_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::get_allocator() const {
+    return alloc;
+}
+
+/********************************************************************************
+ * empty
+ * ------------------------------------------------------------------------------
+ * Checks if the set has no elements. Like size(), the answer may be stale by
+ * the time it is used if other threads are writing.
+ *
+ * Returns:
+ *   - true if empty, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::empty() const {
+    return size() == 0;
+}
+
+/********************************************************************************
+ * size
+ * ------------------------------------------------------------------------------
+ * Sums the element counts of all shards without locking them. Exact when no
+ * writer is running.
+ *
+ * Returns:
+ *   - Number of elements stored.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size() const {
+    size_type total = 0;
+    for (size_type i = 0; i < shard_count_; ++i)
+        total += shards[i].count.load(std::memory_order_relaxed);
+    return total;
+}
+
+/********************************************************************************
+ * bucket_count
+ * ------------------------------------------------------------------------------
+ * Sums the bucket counts of all shards.
+ *
+ * Returns:
+ *   - Total number of buckets.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::bucket_count() const {
+    unordered_set_detail::epoch_guard guard;
+    size_type total = 0;
+    for (size_type i = 0; i < shard_count_; ++i)
+        total += shards[i].table.load(std::memory_order_acquire)->mask + 1;
+    return total;
+}
+
+/********************************************************************************
+ * shard_count
+ * ------------------------------------------------------------------------------
+ * Returns the number of independently locked shards.
+ *
+ * Returns:
+ *   - The shard count.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::shard_count() const {
+    return shard_count_;
+}
+
+/********************************************************************************
+ * load_factor
+ * ------------------------------------------------------------------------------
+ * Computes the average number of elements per bucket over all shards.
+ *
+ * Returns:
+ *   - The ratio of size() to bucket_count().
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+float concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::load_factor() const {
+    return static_cast<float>(size()) / bucket_count();
+}
+
+/********************************************************************************
+ * max_load_factor (getter)
+ * ------------------------------------------------------------------------------
+ * Returns the maximum load factor each shard is kept under.
+ *
+ * Returns:
+ *   - Current max load factor.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+float concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::max_load_factor() const {
+    return max_load_factor_.load(std::memory_order_relaxed);
+}
+
+/********************************************************************************
+ * max_load_factor (setter)
+ * ------------------------------------------------------------------------------
+ * Sets a new maximum load factor and, as unordered_set does, grows every
+ * shard that is already over it. Shards are resized one at a time through
+ * rehash(0), so only one shard's writers wait at any moment.
+ *
+ * Parameters:
+ *   - ml: The new maximum load factor.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::max_load_factor(float ml) {
+    max_load_factor_.store(ml, std::memory_order_relaxed);
+    rehash(0);
+}
+
+/********************************************************************************
+ * clear
+ * ------------------------------------------------------------------------------
+ * Removes all elements, one shard at a time. Readers may still see elements
+ * of shards not yet cleared. The nodes are retired, not freed immediately.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::clear() {
+    for (size_type i = 0; i < shard_count_; ++i) {
+        shard& s = shards[i];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        bucket_table* table = s.table.load(std::memory_order_relaxed);
+        for (size_type b = 0; b <= table->mask; ++b) {
+            Node* current = table->buckets[b].load(std::memory_order_relaxed);
+            table->buckets[b].store(nullptr, std::memory_order_release);
+            while (current) {
+                Node* next = current->next.load(std::memory_order_relaxed);
+                retire(s, current);
+                current = next;
+            }
+        }
+        s.count.store(0, std::memory_order_relaxed);
+    }
+}
+
+/********************************************************************************
+ * insert (lvalue)
+ * ------------------------------------------------------------------------------
+ * Inserts a copy of value unless an equal key is present. Only the owning
+ * shard is locked.
+ *
+ * Parameters:
+ *   - value: The value to insert.
+ *
+ * Returns:
+ *   - true if the value was inserted, false if the key already existed.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::insert(const value_type& value) {
+    return insert_value(value);
+}
+
+/********************************************************************************
+ * insert (rvalue)
+ * ------------------------------------------------------------------------------
+ * Inserts value by moving it unless an equal key is present. Only the owning
+ * shard is locked.
+ *
+ * Parameters:
+ *   - value: The value to insert.
+ *
+ * Returns:
+ *   - true if the value was inserted, false if the key already existed.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::insert(value_type&& value) {
+    return insert_value(std::move(value));
+}
+
+/********************************************************************************
+ * emplace
+ * ------------------------------------------------------------------------------
+ * Constructs a value from args and inserts it. A single value_type argument
+ * is looked up as is and only copied or moved into a node on a miss. Other
+ * argument lists are built into a temporary before any lock is taken, since
+ * its hash decides which shard to lock, and the temporary is moved in on a
+ * miss.
+ *
+ * Parameters:
+ *   - args: Arguments forwarded to the value_type constructor.
+ *
+ * Returns:
+ *   - true if the value was inserted, false if the key already existed.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename... Args>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::emplace(Args&&... args) {
+    if constexpr (sizeof...(Args) == 1 && std::conjunction<std::is_same<std::decay_t<Args>, value_type>...>::value)
+        return insert_value(std::forward<Args>(args)...);
+    else
+        return insert_value(value_type(std::forward<Args>(args)...));
+}
+
+/********************************************************************************
+ * erase
+ * ------------------------------------------------------------------------------
+ * Removes the element with the given key. The node is unlinked under the
+ * shard's mutex and destroyed once no reader can still be looking at it.
+ *
+ * Parameters:
+ *   - key: The key to remove.
+ *
+ * Returns:
+ *   - The number of elements removed (0 or 1).
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::erase(const key_type& key) {
+    size_type hash = hash_of(key);
+    shard& s = shard_for(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::atomic<Node*>* link = find_link(s, key, hash);
+    if (!link)
+        return 0;
+    Node* node = link->load(std::memory_order_relaxed);
+    link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+    s.count.store(s.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    retire(s, node);
+    return 1;
+}
+
+/********************************************************************************
+ * count
+ * ------------------------------------------------------------------------------
+ * Counts elements with the given key without taking any lock.
+ *
+ * Parameters:
+ *   - key: The key to count.
+ *
+ * Returns:
+ *   - 1 if the key is present, 0 otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::count(const key_type& key) const {
+    return contains(key) ? 1 : 0;
+}
+
+/********************************************************************************
+ * contains
+ * ------------------------------------------------------------------------------
+ * Checks whether the key is present without taking any lock.
+ *
+ * Parameters:
+ *   - key: The key to look for.
+ *
+ * Returns:
+ *   - true if the key is present, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::contains(const key_type& key) const {
+    unordered_set_detail::epoch_guard guard;
+    return find_node(key, hash_of(key)) != nullptr;
+}
+
+/********************************************************************************
+ * visit
+ * ------------------------------------------------------------------------------
+ * The concurrent counterpart of find. Looks the key up without taking any
+ * lock and, if it is present, calls f with a const reference to the stored
+ * element. The element stays alive until f returns even if another thread
+ * erases it meanwhile.
+ *
+ * Parameters:
+ *   - key: The key to look for.
+ *   - f: Callable invoked as f(const value_type&).
+ *
+ * Returns:
+ *   - true if the key was found and f was called, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename F>
+bool concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::visit(const key_type& key, F&& f) const {
+    unordered_set_detail::epoch_guard guard;
+    const Node* node = find_node(key, hash_of(key));
+    if (!node)
+        return false;
+    f(node->value);
+    return true;
+}
+
+/********************************************************************************
+ * for_each
+ * ------------------------------------------------------------------------------
+ * Calls f on every element, one shard at a time. Each shard's nodes are
+ * collected under its mutex, which is released before f runs, so f may
+ * insert, erase or visit on the same set. The epoch guard keeps every
+ * collected node alive until the walk ends, even if it is erased meanwhile.
+ * Each shard is seen as it was when collected; elements inserted or erased
+ * during the walk may or may not be visited.
+ *
+ * Parameters:
+ *   - f: Callable invoked as f(const value_type&).
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename F>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::for_each(F&& f) const {
+    unordered_set_detail::epoch_guard guard;
+    std::vector<const Node*> nodes;
+    for (size_type i = 0; i < shard_count_; ++i) {
+        shard& s = shards[i];
+        nodes.clear();
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            nodes.reserve(s.count.load(std::memory_order_relaxed));
+            const bucket_table* table = s.table.load(std::memory_order_relaxed);
+            for (size_type b = 0; b <= table->mask; ++b) {
+                for (const Node* current = table->buckets[b].load(std::memory_order_relaxed); current;
+                     current = current->next.load(std::memory_order_relaxed))
+                    nodes.push_back(current);
+            }
+        }
+        for (const Node* node : nodes)
+            f(node->value);
+    }
+}
+
+/********************************************************************************
+ * rehash
+ * ------------------------------------------------------------------------------
+ * Grows the shards so that together they have at least new_bucket_count
+ * buckets and each stays under the maximum load factor. Shards are resized
+ * one at a time, never all at once. Like unordered_set::rehash, this never
+ * shrinks a shard.
+ *
+ * Parameters:
+ *   - new_bucket_count: The desired total number of buckets.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::rehash(size_type new_bucket_count) {
+    size_type per_shard = (new_bucket_count + shard_count_ - 1) / shard_count_;
+    float ml = max_load_factor_.load(std::memory_order_relaxed);
+    for (size_type i = 0; i < shard_count_; ++i) {
+        shard& s = shards[i];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        size_type needed = static_cast<size_type>(s.count.load(std::memory_order_relaxed) / ml) + 1;
+        rehash_shard(s, std::max(per_shard, needed));
+    }
+}
+
+/********************************************************************************
+ * reserve
+ * ------------------------------------------------------------------------------
+ * Grows the shards so that count elements, spread evenly, fit without any
+ * further resize.
+ *
+ * Parameters:
+ *   - count: Number of elements to reserve space for.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void concurrent_unordered_set<Key, Hash, KeyEqual, Allocator>::reserve(size_type count) {
+    rehash(static_cast<size_type>(count / max_load_factor()) + 1);
+}
@@ -0,0 +1,144 @@
+#ifndef EPOCH_RECLAMATION_HPP
+#define EPOCH_RECLAMATION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace unordered_set_detail {
+
+constexpr std::size_t kCacheLineSize = 64;
+
+/********************************************************************************
+ * epoch_domain
+ * ------------------------------------------------------------------------------
+ * Epoch-based memory reclamation shared by all concurrent containers. A thread
+ * pins itself (enter) before it reads shared nodes without a lock and unpins
+ * itself (leave) when done. A writer that unlinks a node tags it with
+ * current() and may free it once the global epoch has moved two steps beyond
+ * that tag: try_advance only moves the epoch forward when every pinned thread
+ * has observed the current one, so no reader can still hold the node.
+ *
+ * Each thread gets a cache-line sized record on first use. Records are never
+ * freed; a record whose thread has exited is reused by the next new thread.
+ * Pinning nests, so a pinned thread may call other pinning code.
+ *
+ * The seq_cst fences only keep a pin ordered before the reads it protects.
+ * Every edge a reclaimer needs before freeing memory is an acquire load of a
+ * record or of the epoch, paired with a release store, so ThreadSanitizer,
+ * which ignores fences, still sees why the free is safe.
+ ********************************************************************************/
+class epoch_domain {
+public:
+    static epoch_domain& instance() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    void enter() {
+        thread_record* rec = local_record();
+        if (rec->depth++ == 0) {
+            rec->epoch.store(global_epoch.load(std::memory_order_acquire), std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void leave() {
+        thread_record* rec = local_record();
+        if (--rec->depth == 0)
+            rec->epoch.store(kUnpinned, std::memory_order_release);
+    }
+
+    // Epoch to tag a node with after it has been unlinked.
+    std::uint64_t current() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return global_epoch.load(std::memory_order_relaxed);
+    }
+
+    // Advances the global epoch if every pinned thread has seen it.
+    std::uint64_t try_advance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+        for (thread_record* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+            std::uint64_t seen = rec->epoch.load(std::memory_order_acquire);
+            if (seen != kUnpinned && seen != epoch)
+                return epoch;
+        }
+        global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+        return global_epoch.load(std::memory_order_acquire);
+    }
+
+    // True when something tagged with retire_epoch can no longer be reached.
+    static bool is_safe(std::uint64_t retire_epoch, std::uint64_t now) {
+        return now >= retire_epoch + 2;
+    }
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+private:
+    static constexpr std::uint64_t kUnpinned = 0;
+
+    struct alignas(kCacheLineSize) thread_record {
+        std::atomic<std::uint64_t> epoch{ kUnpinned };
+        std::atomic<bool> in_use{ true };
+        unsigned depth = 0;
+        thread_record* next = nullptr;
+    };
+
+    // Hands the record back when its thread exits.
+    struct record_owner {
+        thread_record* rec = nullptr;
+        ~record_owner() {
+            if (rec) {
+                rec->epoch.store(kUnpinned, std::memory_order_release);
+                rec->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<std::uint64_t> global_epoch{ 1 };
+    std::atomic<thread_record*> records{ nullptr };
+
+    epoch_domain() = default;
+
+    thread_record* local_record() {
+        static thread_local record_owner owner;
+        if (!owner.rec)
+            owner.rec = acquire_record();
+        return owner.rec;
+    }
+
+    thread_record* acquire_record() {
+        for (thread_record* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+            bool expected = false;
+            if (!rec->in_use.load(std::memory_order_relaxed) &&
+                rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return rec;
+        }
+        thread_record* rec = new thread_record;
+        thread_record* head = records.load(std::memory_order_relaxed);
+        do {
+            rec->next = head;
+        } while (!records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+        return rec;
+    }
+};
+
+/********************************************************************************
+ * epoch_guard
+ * ------------------------------------------------------------------------------
+ * Keeps the calling thread pinned in the epoch domain for its lifetime.
+ ********************************************************************************/
+class epoch_guard {
+public:
+    epoch_guard() { epoch_domain::instance().enter(); }
+    ~epoch_guard() { epoch_domain::instance().leave(); }
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+};
+
+} // namespace unordered_set_detail
+
+#endif
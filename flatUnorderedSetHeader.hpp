@@ -0,0 +1,347 @@
+#ifndef FLAT_UNORDERED_SET_HPP
+#define FLAT_UNORDERED_SET_HPP
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLAT_UNORDERED_SET_SSE2 1
+#endif
+
+#include "unorderedSetDetail.hpp"
+
+namespace unordered_set_detail {
+
+/********************************************************************************
+ * Control bytes
+ * ------------------------------------------------------------------------------
+ * Every slot of a flat_unordered_set has one control byte. A full slot stores
+ * the low 7 bits of its element's hash (0..127); the negative values mark
+ * empty slots and tombstones left behind by erase.
+ ********************************************************************************/
+using ctrl_t = signed char;
+
+constexpr ctrl_t kEmpty = -128;
+constexpr ctrl_t kDeleted = -2;
+
+inline bool is_full(ctrl_t c) { return c >= 0; }
+
+inline unsigned trailing_zeros(std::uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned n = 0;
+    while (!(mask & 1u)) { mask >>= 1; ++n; }
+    return n;
+#endif
+}
+
+inline unsigned leading_zeros(std::uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_clz(mask));
+#else
+    unsigned n = 0;
+    while (!(mask & 0x80000000u)) { mask <<= 1; ++n; }
+    return n;
+#endif
+}
+
+/********************************************************************************
+ * Group
+ * ------------------------------------------------------------------------------
+ * A window of kWidth consecutive control bytes, matched in one instruction
+ * sequence: 32 bytes with AVX2, 16 bytes with SSE2, and a portable byte loop
+ * everywhere else. Each match returns a bit mask with bit i set when byte i
+ * of the window satisfies the predicate.
+ ********************************************************************************/
+#if defined(__AVX2__)
+struct Group {
+    static constexpr std::size_t kWidth = 32;
+    __m256i ctrl;
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos))) {}
+
+    std::uint32_t match(ctrl_t h2) const {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(h2), ctrl)));
+    }
+    std::uint32_t match_empty() const {
+        return match(kEmpty);
+    }
+    std::uint32_t match_empty_or_deleted() const {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(-1), ctrl)));
+    }
+};
+#elif defined(FLAT_UNORDERED_SET_SSE2)
+struct Group {
+    static constexpr std::size_t kWidth = 16;
+    __m128i ctrl;
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    std::uint32_t match(ctrl_t h2) const {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+    }
+    std::uint32_t match_empty() const {
+        return match(kEmpty);
+    }
+    std::uint32_t match_empty_or_deleted() const {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)));
+    }
+};
+#else
+struct Group {
+    static constexpr std::size_t kWidth = 16;
+    ctrl_t ctrl[kWidth];
+
+    explicit Group(const ctrl_t* pos) { std::memcpy(ctrl, pos, kWidth); }
+
+    std::uint32_t match(ctrl_t h2) const {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < kWidth; ++i)
+            mask |= static_cast<std::uint32_t>(ctrl[i] == h2) << i;
+        return mask;
+    }
+    std::uint32_t match_empty() const {
+        return match(kEmpty);
+    }
+    std::uint32_t match_empty_or_deleted() const {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < kWidth; ++i)
+            mask |= static_cast<std::uint32_t>(ctrl[i] < -1) << i;
+        return mask;
+    }
+};
+#endif
+
+} // namespace unordered_set_detail
+
+template<
+    typename Key,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>,
+    typename Allocator = std::allocator<Key>
+>
+class flat_unordered_set {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using ctrl_t = unordered_set_detail::ctrl_t;
+    using Group = unordered_set_detail::Group;
+    using slot_traits = std::allocator_traits<Allocator>;
+    using ctrl_allocator_type = typename slot_traits::template rebind_alloc<ctrl_t>;
+    using ctrl_traits = std::allocator_traits<ctrl_allocator_type>;
+
+    static constexpr float kMaxLoadFactor = 0.875f;
+
+    // Move assignment can only fail when it has to move the elements one by
+    // one into a table from this set's allocator, as std::unordered_set.
+    static constexpr bool kNothrowMoveAssign =
+        (slot_traits::propagate_on_container_move_assignment::value || slot_traits::is_always_equal::value) &&
+        std::is_nothrow_move_assignable<Hash>::value && std::is_nothrow_move_assignable<KeyEqual>::value;
+
+    ctrl_t* ctrl_;
+    value_type* slots_;
+    size_type capacity_;
+    size_type num_elements;
+    size_type growth_left_;
+    float max_load_factor_;
+    hasher hash_func;
+    key_equal key_eq;
+    allocator_type alloc;
+
+    static size_type h1(size_type hash) { return hash >> 7; }
+    static ctrl_t h2(size_type hash) { return static_cast<ctrl_t>(hash & 0x7F); }
+
+    template<typename K>
+    size_type hash_of(const K& key) const;
+    size_type capacity_to_growth(size_type capacity) const;
+    size_type capacity_for(size_type count) const;
+    void set_ctrl(size_type index, ctrl_t value);
+
+    template<typename K>
+    size_type find_index(const K& key, size_type hash) const;
+    size_type find_insert_slot(size_type hash) const;
+    size_type prepare_insert(size_type hash);
+    void erase_at(size_type index);
+
+    void allocate_table(size_type capacity);
+    void deallocate_table(ctrl_t* ctrl, value_type* slots, size_type capacity);
+    void destroy_table();
+    void take_table(flat_unordered_set& other) noexcept;
+    template<typename Source>
+    void clone_table(Source& other);
+    void resize(size_type new_capacity);
+    void rehash_and_grow_if_necessary();
+
+    template<typename K, typename... Args>
+    std::pair<size_type, bool> emplace_unique(const K& key, Args&&... args);
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = flat_unordered_set::value_type;
+        using difference_type = flat_unordered_set::difference_type;
+        using pointer = value_type*;
+        using reference = value_type&;
+
+        iterator() : container(nullptr), slot_index(0) {}
+
+        reference operator*() const {
+            return container->slots_[slot_index];
+        }
+
+        pointer operator->() const {
+            return &(container->slots_[slot_index]);
+        }
+
+        iterator& operator++();
+        iterator operator++(int);
+
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+
+    private:
+        friend class flat_unordered_set;
+        flat_unordered_set* container;
+        size_type slot_index;
+
+        iterator(flat_unordered_set* cont, size_type index)
+            : container(cont), slot_index(index) {}
+    };
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = flat_unordered_set::value_type;
+        using difference_type = flat_unordered_set::difference_type;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() : container(nullptr), slot_index(0) {}
+
+        const_iterator(const iterator& it)
+            : container(it.container), slot_index(it.slot_index) {}
+
+        reference operator*() const {
+            return container->slots_[slot_index];
+        }
+
+        pointer operator->() const {
+            return &(container->slots_[slot_index]);
+        }
+
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        friend class flat_unordered_set;
+        const flat_unordered_set* container;
+        size_type slot_index;
+
+        const_iterator(const flat_unordered_set* cont, size_type index)
+            : container(cont), slot_index(index) {}
+    };
+
+private:
+    template<typename K>
+    using enable_if_transparent_t = std::enable_if_t<
+        unordered_set_detail::is_transparent_lookup<Hash, KeyEqual>::value &&
+        !std::is_convertible<const K&, iterator>::value &&
+        !std::is_convertible<const K&, const_iterator>::value, int>;
+
+    template<typename K>
+    using enable_if_key_or_transparent_t = std::enable_if_t<
+        std::is_same<std::decay_t<K>, key_type>::value ||
+        unordered_set_detail::is_transparent_lookup<Hash, KeyEqual>::value, int>;
+
+public:
+    flat_unordered_set();
+    explicit flat_unordered_set(size_type bucket_count_, const hasher& hash_func_ = hasher(), const key_equal& equal = key_equal(), const allocator_type& alloc_ = allocator_type());
+    flat_unordered_set(std::initializer_list<value_type> init, size_type bucket_count_ = 0, const hasher& hash_func_ = hasher(), const key_equal& equal = key_equal(), const allocator_type& alloc_ = allocator_type());
+    flat_unordered_set(const flat_unordered_set& other);
+    flat_unordered_set(const flat_unordered_set& other, const allocator_type& alloc_);
+    flat_unordered_set(flat_unordered_set&& other) noexcept;
+    flat_unordered_set& operator=(const flat_unordered_set& other);
+    flat_unordered_set& operator=(flat_unordered_set&& other) noexcept(kNothrowMoveAssign);
+    ~flat_unordered_set();
+
+    allocator_type get_allocator() const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    size_type size() const;
+    size_type bucket_count() const;
+    float load_factor() const;
+    float max_load_factor() const;
+    void max_load_factor(float ml);
+
+    void clear();
+    std::pair<iterator, bool> insert(const value_type& value);
+    std::pair<iterator, bool> insert(value_type&& value);
+
+    iterator insert(const_iterator hint, const value_type& value);
+    iterator insert(const_iterator hint, value_type&& value);
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    template<typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
+    template<typename K, typename... Args, typename = enable_if_key_or_transparent_t<K>>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
+
+    iterator erase(const_iterator pos);
+    iterator erase(iterator pos);
+    size_type erase(const key_type& key);
+    template<typename K, typename = enable_if_transparent_t<K>>
+    size_type erase(const K& key);
+
+    iterator find(const key_type& key);
+    const_iterator find(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    iterator find(const K& key);
+    template<typename K, typename = enable_if_transparent_t<K>>
+    const_iterator find(const K& key) const;
+    size_type count(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    size_type count(const K& key) const;
+    bool contains(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    bool contains(const K& key) const;
+
+    void rehash(size_type new_bucket_count);
+    void reserve(size_type count);
+    void swap(flat_unordered_set& other) noexcept;
+};
+
+#include "flatUnorderedSetImplementation.tpp"
+
+#endif
@@ -0,0 +1,1358 @@
+#include "flatUnorderedSetHeader.hpp"
+
+/********************************************************************************
+ * hash_of
+ * ------------------------------------------------------------------------------
+ * Hashes a key with the user's hasher and mixes the result, so that both the
+ * probe start (h1) and the 7-bit control tag (h2) are well distributed.
+ *
+ * Parameters:
+ *   - key: The key to hash; any type the hasher accepts.
+ *
+ * Returns:
+ *   - The mixed hash value.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::hash_of(const K& key) const {
+    return unordered_set_detail::mix_hash(hash_func(key));
+}
+
+/********************************************************************************
+ * capacity_to_growth
+ * ------------------------------------------------------------------------------
+ * Computes how many elements a table of the given capacity may hold before it
+ * has to grow. At least one slot is always kept empty so that every probe
+ * sequence terminates.
+ *
+ * Parameters:
+ *   - capacity: Number of slots in the table.
+ *
+ * Returns:
+ *   - Maximum number of full (or deleted) slots allowed.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::capacity_to_growth(size_type capacity) const {
+    if (capacity == 0)
+        return 0;
+    size_type growth = static_cast<size_type>(capacity * max_load_factor_);
+    if (growth >= capacity)
+        growth = capacity - 1;
+    return growth > 0 ? growth : 1;
+}
+
+/********************************************************************************
+ * capacity_for
+ * ------------------------------------------------------------------------------
+ * Computes the smallest power-of-two capacity (at least one Group wide) that can
+ * hold count elements without exceeding the max load factor.
+ *
+ * Parameters:
+ *   - count: The number of elements to accommodate.
+ *
+ * Returns:
+ *   - The required capacity, or 0 if count is 0.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::capacity_for(size_type count) const {
+    if (count == 0)
+        return 0;
+    size_type capacity = Group::kWidth;
+    while (capacity_to_growth(capacity) < count)
+        capacity *= 2;
+    return capacity;
+}
+
+/********************************************************************************
+ * set_ctrl
+ * ------------------------------------------------------------------------------
+ * Writes a control byte. The first Group::kWidth bytes are mirrored past the
+ * end of the control array so that a Group load starting near the end of the
+ * table wraps around without a bounds check.
+ *
+ * Parameters:
+ *   - index: Slot index.
+ *   - value: New control byte.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::set_ctrl(size_type index, ctrl_t value) {
+    ctrl_[index] = value;
+    if (index < Group::kWidth)
+        ctrl_[capacity_ + index] = value;
+}
+
+/********************************************************************************
+ * find_index
+ * ------------------------------------------------------------------------------
+ * Probes the table for key. Each step loads one Group of control bytes, tests
+ * the slots whose 7-bit tag matches, and stops at the first Group containing an
+ * empty slot. Groups are visited in triangular order, which covers the whole
+ * power-of-two table.
+ *
+ * Parameters:
+ *   - key: The key to look for; key_type or a transparent lookup type.
+ *   - hash: The mixed hash of key.
+ *
+ * Returns:
+ *   - Slot index of the element, or capacity_ if it is not present.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::find_index(const K& key, size_type hash) const {
+    if (capacity_ == 0)
+        return capacity_;
+    const size_type mask = capacity_ - 1;
+    const ctrl_t tag = h2(hash);
+    size_type pos = h1(hash) & mask;
+    size_type step = 0;
+    while (true) {
+        Group group(ctrl_ + pos);
+        for (std::uint32_t match = group.match(tag); match; match &= match - 1) {
+            size_type index = (pos + unordered_set_detail::trailing_zeros(match)) & mask;
+            if (key_eq(slots_[index], key))
+                return index;
+        }
+        if (group.match_empty())
+            return capacity_;
+        step += Group::kWidth;
+        pos = (pos + step) & mask;
+    }
+}
+
+/********************************************************************************
+ * find_insert_slot
+ * ------------------------------------------------------------------------------
+ * Follows the probe sequence for hash and returns the first empty or deleted
+ * slot. The table must have a nonzero capacity.
+ *
+ * Parameters:
+ *   - hash: The mixed hash of the key being inserted.
+ *
+ * Returns:
+ *   - Index of a slot that can receive the new element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::find_insert_slot(size_type hash) const {
+    const size_type mask = capacity_ - 1;
+    size_type pos = h1(hash) & mask;
+    size_type step = 0;
+    while (true) {
+        std::uint32_t match = Group(ctrl_ + pos).match_empty_or_deleted();
+        if (match)
+            return (pos + unordered_set_detail::trailing_zeros(match)) & mask;
+        step += Group::kWidth;
+        pos = (pos + step) & mask;
+    }
+}
+
+/********************************************************************************
+ * prepare_insert
+ * ------------------------------------------------------------------------------
+ * Finds the slot a new element with the given hash will occupy, growing or
+ * compacting the table first if no growth budget is left. Reusing a tombstone
+ * does not consume budget.
+ *
+ * Parameters:
+ *   - hash: The mixed hash of the key being inserted.
+ *
+ * Returns:
+ *   - Index of the slot to construct the new element in.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::prepare_insert(size_type hash) {
+    if (capacity_ == 0)
+        rehash_and_grow_if_necessary();
+    size_type target = find_insert_slot(hash);
+    if (growth_left_ == 0 && ctrl_[target] != unordered_set_detail::kDeleted) {
+        rehash_and_grow_if_necessary();
+        target = find_insert_slot(hash);
+    }
+    return target;
+}
+
+/********************************************************************************
+ * erase_at
+ * ------------------------------------------------------------------------------
+ * Destroys the element in the given slot. If no probe sequence can have passed
+ * over the slot while it was full (there is an empty slot within one Group on
+ * both sides), it is marked empty again; otherwise it becomes a tombstone.
+ *
+ * Parameters:
+ *   - index: Index of a full slot.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::erase_at(size_type index) {
+    slot_traits::destroy(alloc, slots_ + index);
+    --num_elements;
+
+    size_type index_before = (index - Group::kWidth) & (capacity_ - 1);
+    std::uint32_t empty_after = Group(ctrl_ + index).match_empty();
+    std::uint32_t empty_before = Group(ctrl_ + index_before).match_empty();
+    bool was_never_full = empty_before && empty_after &&
+        unordered_set_detail::trailing_zeros(empty_after) +
+        unordered_set_detail::leading_zeros(empty_before) - (32 - Group::kWidth) < Group::kWidth;
+
+    if (was_never_full) {
+        set_ctrl(index, unordered_set_detail::kEmpty);
+        ++growth_left_;
+    }
+    else {
+        set_ctrl(index, unordered_set_detail::kDeleted);
+    }
+}
+
+/********************************************************************************
+ * allocate_table
+ * ------------------------------------------------------------------------------
+ * Allocates control bytes and uninitialized slot storage for the given capacity
+ * through the allocator, marks every slot empty and resets the growth budget.
+ * The previous table pointers are overwritten, not released. If either
+ * allocation throws, nothing is changed.
+ *
+ * Parameters:
+ *   - capacity: Number of slots; a power of two no smaller than Group::kWidth.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::allocate_table(size_type capacity) {
+    ctrl_allocator_type ctrl_alloc(alloc);
+    ctrl_t* ctrl = ctrl_traits::allocate(ctrl_alloc, capacity + Group::kWidth);
+    try {
+        slots_ = slot_traits::allocate(alloc, capacity);
+    }
+    catch (...) {
+        ctrl_traits::deallocate(ctrl_alloc, ctrl, capacity + Group::kWidth);
+        throw;
+    }
+    ctrl_ = ctrl;
+    std::memset(ctrl_, static_cast<unsigned char>(unordered_set_detail::kEmpty), capacity + Group::kWidth);
+    capacity_ = capacity;
+    growth_left_ = capacity_to_growth(capacity);
+}
+
+/********************************************************************************
+ * deallocate_table
+ * ------------------------------------------------------------------------------
+ * Returns the storage of a table to the allocator. Elements must already have
+ * been destroyed or moved out.
+ *
+ * Parameters:
+ *   - ctrl: Control byte array.
+ *   - slots: Slot array.
+ *   - capacity: Capacity the table was allocated with.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::deallocate_table(ctrl_t* ctrl, value_type* slots, size_type capacity) {
+    if (capacity == 0)
+        return;
+    ctrl_allocator_type ctrl_alloc(alloc);
+    ctrl_traits::deallocate(ctrl_alloc, ctrl, capacity + Group::kWidth);
+    slot_traits::deallocate(alloc, slots, capacity);
+}
+
+/********************************************************************************
+ * destroy_table
+ * ------------------------------------------------------------------------------
+ * Destroys every element, releases the table storage and leaves the container
+ * empty with zero capacity.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::destroy_table() {
+    for (size_type i = 0; i < capacity_; ++i) {
+        if (unordered_set_detail::is_full(ctrl_[i]))
+            slot_traits::destroy(alloc, slots_ + i);
+    }
+    deallocate_table(ctrl_, slots_, capacity_);
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    num_elements = 0;
+    growth_left_ = 0;
+}
+
+/********************************************************************************
+ * take_table
+ * ------------------------------------------------------------------------------
+ * Takes over the table of other, which this set's allocator must be able to
+ * free, and leaves other empty with zero capacity. This set must have no
+ * table of its own.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set whose table is taken.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::take_table(flat_unordered_set& other) noexcept {
+    ctrl_ = std::exchange(other.ctrl_, nullptr);
+    slots_ = std::exchange(other.slots_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    num_elements = std::exchange(other.num_elements, 0);
+    growth_left_ = std::exchange(other.growth_left_, 0);
+}
+
+/********************************************************************************
+ * clone_table
+ * ------------------------------------------------------------------------------
+ * Builds a table of other's capacity from this set's allocator and copies
+ * every element of other into the slot it occupies there, without hashing or
+ * probing; from a non-const other the elements are moved instead. This set
+ * must have no table. If an element throws, the ones built so far are
+ * destroyed, the table is released and this set is left empty.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set to copy or move the elements from.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename Source>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::clone_table(Source& other) {
+    if (other.capacity_ == 0)
+        return;
+    allocate_table(other.capacity_);
+    size_type i = 0;
+    try {
+        for (; i < capacity_; ++i) {
+            if (!unordered_set_detail::is_full(other.ctrl_[i]))
+                continue;
+            if constexpr (std::is_const<Source>::value)
+                slot_traits::construct(alloc, slots_ + i, other.slots_[i]);
+            else
+                slot_traits::construct(alloc, slots_ + i, std::move(other.slots_[i]));
+        }
+    }
+    catch (...) {
+        while (i-- > 0) {
+            if (unordered_set_detail::is_full(other.ctrl_[i]))
+                slot_traits::destroy(alloc, slots_ + i);
+        }
+        deallocate_table(ctrl_, slots_, capacity_);
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = 0;
+        growth_left_ = 0;
+        throw;
+    }
+    std::memcpy(ctrl_, other.ctrl_, capacity_ + Group::kWidth);
+    num_elements = other.num_elements;
+    growth_left_ = other.growth_left_;
+}
+
+/********************************************************************************
+ * resize
+ * ------------------------------------------------------------------------------
+ * Moves every element into a freshly allocated table of the given capacity.
+ * Tombstones are dropped in the process. If hashing or moving an element
+ * throws, every element of both tables is destroyed and the container is
+ * left empty, rather than leaking either table.
+ *
+ * Parameters:
+ *   - new_capacity: Capacity of the new table.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::resize(size_type new_capacity) {
+    ctrl_t* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    size_type old_capacity = capacity_;
+
+    allocate_table(new_capacity);
+    size_type i = 0;
+    try {
+        for (; i < old_capacity; ++i) {
+            if (!unordered_set_detail::is_full(old_ctrl[i]))
+                continue;
+            size_type hash = hash_of(old_slots[i]);
+            size_type target = find_insert_slot(hash);
+            slot_traits::construct(alloc, slots_ + target, std::move(old_slots[i]));
+            slot_traits::destroy(alloc, old_slots + i);
+            set_ctrl(target, h2(hash));
+        }
+    }
+    catch (...) {
+        // The element at i is still in the old table.
+        for (; i < old_capacity; ++i) {
+            if (unordered_set_detail::is_full(old_ctrl[i]))
+                slot_traits::destroy(alloc, old_slots + i);
+        }
+        deallocate_table(old_ctrl, old_slots, old_capacity);
+        destroy_table();
+        throw;
+    }
+    growth_left_ -= num_elements;
+    deallocate_table(old_ctrl, old_slots, old_capacity);
+}
+
+/********************************************************************************
+ * rehash_and_grow_if_necessary
+ * ------------------------------------------------------------------------------
+ * Called when the growth budget is exhausted. If at most half of the budget is
+ * taken by live elements the rest are tombstones, so the table is rebuilt in
+ * place at the same capacity; otherwise its capacity is doubled.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::rehash_and_grow_if_necessary() {
+    if (capacity_ == 0)
+        resize(Group::kWidth);
+    else if (num_elements <= capacity_to_growth(capacity_) / 2)
+        resize(capacity_);
+    else
+        resize(capacity_ * 2);
+}
+
+/********************************************************************************
+ * emplace_unique
+ * ------------------------------------------------------------------------------
+ * Looks up key and, only if it is absent, constructs the value from args
+ * directly in its slot. Shared by insert, emplace and try_emplace.
+ *
+ * Parameters:
+ *   - key: The lookup key; must compare equal to the value built from args.
+ *   - args: Arguments for constructing the value on a miss.
+ *
+ * Returns:
+ *   - Pair of the slot index holding the element and a bool indicating
+ *     whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename... Args>
+std::pair<typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type, bool>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::emplace_unique(const K& key, Args&&... args) {
+    size_type hash = hash_of(key);
+    size_type index = find_index(key, hash);
+    if (index != capacity_)
+        return { index, false };
+
+    index = prepare_insert(hash);
+    slot_traits::construct(alloc, slots_ + index, std::forward<Args>(args)...);
+    if (ctrl_[index] == unordered_set_detail::kEmpty)
+        --growth_left_;
+    set_ctrl(index, h2(hash));
+    ++num_elements;
+    return { index, true };
+}
+
+/********************************************************************************
+ * Default Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs an empty flat_unordered_set. No storage is allocated until the
+ * first insertion.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::flat_unordered_set()
+    : ctrl_(nullptr), slots_(nullptr), capacity_(0), num_elements(0), growth_left_(0),
+      max_load_factor_(kMaxLoadFactor), hash_func(Hash()), key_eq(KeyEqual()), alloc(Allocator())
+{
+}
+
+/********************************************************************************
+ * Constructor with bucket_count_
+ * ------------------------------------------------------------------------------
+ * Constructs a flat_unordered_set with at least the given number of slots and a
+ * user-defined hash functor, key equality function, and allocator.
+ *
+ * Parameters:
+ *   - bucket_count_: Minimum initial number of slots.
+ *   - hash_func_: Hash function for keys.
+ *   - equal: Equality function for keys.
+ *   - alloc_: Allocator to use.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::flat_unordered_set(size_type bucket_count_,
+                                                                        const hasher& hash_func_,
+                                                                        const key_equal& equal,
+                                                                        const allocator_type& alloc_)
+    : ctrl_(nullptr), slots_(nullptr), capacity_(0), num_elements(0), growth_left_(0),
+      max_load_factor_(kMaxLoadFactor), hash_func(hash_func_), key_eq(equal), alloc(alloc_)
+{
+    rehash(bucket_count_);
+}
+
+/********************************************************************************
+ * Initializer List Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs a flat_unordered_set from an initializer_list, reserving room for
+ * all of its values up front.
+ *
+ * Parameters:
+ *   - init: Initializer list of values.
+ *   - bucket_count_: Minimum initial number of slots (optional).
+ *   - hash_func_: Hash function.
+ *   - equal: Equality function.
+ *   - alloc_: Allocator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::flat_unordered_set(
+    std::initializer_list<value_type> init,
+    size_type bucket_count_,
+    const hasher& hash_func_,
+    const key_equal& equal,
+    const allocator_type& alloc_)
+    : flat_unordered_set(bucket_count_, hash_func_, equal, alloc_)
+{
+    reserve(init.size());
+    for (const auto& val : init) {
+        insert(val);
+    }
+}
+
+/********************************************************************************
+ * Copy Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs a copy of an existing flat_unordered_set. The copy uses the same
+ * capacity and control bytes, so every element is copied straight into the
+ * slot it occupies in other without hashing or probing (see clone_table). The
+ * second form takes the allocator to use instead of other's.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set to copy.
+ *   - alloc_: Allocator for the copy.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::flat_unordered_set(const flat_unordered_set& other)
+    : flat_unordered_set(other, slot_traits::select_on_container_copy_construction(other.alloc))
+{
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::flat_unordered_set(const flat_unordered_set& other,
+                                                                        const allocator_type& alloc_)
+    : ctrl_(nullptr), slots_(nullptr), capacity_(0), num_elements(0), growth_left_(0),
+      max_load_factor_(other.max_load_factor_), hash_func(other.hash_func),
+      key_eq(other.key_eq), alloc(alloc_)
+{
+    clone_table(other);
+}
+
+/********************************************************************************
+ * Move Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs a new flat_unordered_set by taking over the table of another one.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set to move from.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::flat_unordered_set(flat_unordered_set&& other) noexcept
+    : ctrl_(other.ctrl_), slots_(other.slots_), capacity_(other.capacity_),
+      num_elements(other.num_elements), growth_left_(other.growth_left_),
+      max_load_factor_(other.max_load_factor_), hash_func(std::move(other.hash_func)),
+      key_eq(std::move(other.key_eq)), alloc(std::move(other.alloc))
+{
+    other.ctrl_ = nullptr;
+    other.slots_ = nullptr;
+    other.capacity_ = 0;
+    other.num_elements = 0;
+    other.growth_left_ = 0;
+}
+
+/********************************************************************************
+ * Copy Assignment Operator
+ * ------------------------------------------------------------------------------
+ * Replaces the contents with a copy of other. The copy is built first, from
+ * the allocator this set will end up with: other's if the allocator
+ * propagates on copy assignment, this set's otherwise. If an element copy
+ * throws, this set is left unchanged.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set to copy from.
+ *
+ * Returns:
+ *   - Reference to this flat_unordered_set.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>&
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::operator=(const flat_unordered_set& other) {
+    if (this != &other) {
+        constexpr bool propagate = slot_traits::propagate_on_container_copy_assignment::value;
+        flat_unordered_set copy(other, propagate ? other.alloc : alloc);
+        destroy_table();
+        if constexpr (propagate)
+            alloc = other.alloc;
+        take_table(copy);
+        max_load_factor_ = other.max_load_factor_;
+        hash_func = other.hash_func;
+        key_eq = other.key_eq;
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * Move Assignment Operator
+ * ------------------------------------------------------------------------------
+ * Releases the current table and takes over the table of other when the
+ * allocators allow it: the allocator propagates on move assignment, or the
+ * two compare equal. Otherwise each element is moved out of other's slot
+ * into a table from this set's allocator, and other is left empty. Only that
+ * path can throw, so the operator is noexcept whenever the allocator
+ * propagates on move assignment or always compares equal.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set to move from.
+ *
+ * Returns:
+ *   - Reference to this flat_unordered_set.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>&
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::operator=(flat_unordered_set&& other) noexcept(kNothrowMoveAssign) {
+    if (this != &other) {
+        constexpr bool propagate = slot_traits::propagate_on_container_move_assignment::value;
+        destroy_table();
+        max_load_factor_ = other.max_load_factor_;
+        hash_func = std::move(other.hash_func);
+        key_eq = std::move(other.key_eq);
+        if (propagate || alloc == other.alloc) {
+            if constexpr (propagate)
+                alloc = std::move(other.alloc);
+            take_table(other);
+        }
+        else {
+            // other's slots came from an allocator that cannot free them here.
+            clone_table(other);
+            other.destroy_table();
+        }
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * Destructor
+ * ------------------------------------------------------------------------------
+ * Destroys all elements and releases the table storage.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::~flat_unordered_set() {
+    destroy_table();
+}
+
+/********************************************************************************
+ * get_allocator
+ * ------------------------------------------------------------------------------
+ * Returns a copy of the allocator that supplies the table storage.
+ *
+ * Returns:
+ *   - The container's allocator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::allocator_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::get_allocator() const {
+    return alloc;
+}
+
+/********************************************************************************
+ * iterator::operator++ (Prefix)
+ * ------------------------------------------------------------------------------
+ * Advances the iterator to the next full slot.
+ *
+ * Returns:
+ *   - Reference to the updated iterator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator&
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator++() {
+    ++slot_index;
+    while (slot_index < container->capacity_ && !unordered_set_detail::is_full(container->ctrl_[slot_index])) {
+        ++slot_index;
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * iterator::operator++ (Postfix)
+ * ------------------------------------------------------------------------------
+ * Advances the iterator to the next element, returning the original value.
+ *
+ * Returns:
+ *   - Iterator pointing to the element before the increment.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator++(int) {
+    iterator tmp = *this;
+    ++(*this);
+    return tmp;
+}
+
+/********************************************************************************
+ * iterator::operator== and operator!=
+ * ------------------------------------------------------------------------------
+ * Compares two iterators for equality and inequality.
+ *
+ * Returns:
+ *   - true if both iterators point to the same slot of the same container.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator==(const iterator &other) const {
+    return container == other.container && slot_index == other.slot_index;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator!=(const iterator &other) const {
+    return !(*this == other);
+}
+
+/********************************************************************************
+ * const_iterator::operator++ (Prefix)
+ * ------------------------------------------------------------------------------
+ * Advances the const_iterator to the next full slot.
+ *
+ * Returns:
+ *   - Reference to the updated const_iterator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator&
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator++() {
+    ++slot_index;
+    while (slot_index < container->capacity_ && !unordered_set_detail::is_full(container->ctrl_[slot_index])) {
+        ++slot_index;
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * const_iterator::operator++ (Postfix)
+ * ------------------------------------------------------------------------------
+ * Advances the const_iterator to the next element, returning its previous state.
+ *
+ * Returns:
+ *   - Const iterator pointing to the element before the increment.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator++(int) {
+    const_iterator tmp = *this;
+    ++(*this);
+    return tmp;
+}
+
+/********************************************************************************
+ * const_iterator::operator== and operator!=
+ * ------------------------------------------------------------------------------
+ * Compares two const_iterators for equality and inequality.
+ *
+ * Returns:
+ *   - true if both const_iterators point to the same slot of the same container.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator==(const const_iterator &other) const {
+    return container == other.container && slot_index == other.slot_index;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator!=(const const_iterator &other) const {
+    return !(*this == other);
+}
+
+/********************************************************************************
+ * begin() - iterator version
+ * ------------------------------------------------------------------------------
+ * Returns an iterator to the first element in the flat_unordered_set.
+ *
+ * Returns:
+ *   - Iterator to the first element, or end() if the container is empty.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::begin() {
+    size_type i = 0;
+    while (i < capacity_ && !unordered_set_detail::is_full(ctrl_[i]))
+        ++i;
+    return iterator(this, i);
+}
+
+/********************************************************************************
+ * end() - iterator version
+ * ------------------------------------------------------------------------------
+ * Returns an iterator representing the end of the flat_unordered_set.
+ *
+ * Returns:
+ *   - Iterator representing the past-the-end element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::end() {
+    return iterator(this, capacity_);
+}
+
+/********************************************************************************
+ * begin() - const_iterator version
+ * ------------------------------------------------------------------------------
+ * Returns a const_iterator to the first element in the flat_unordered_set.
+ *
+ * Returns:
+ *   - Const iterator to the first element, or end() if the container is empty.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::begin() const {
+    size_type i = 0;
+    while (i < capacity_ && !unordered_set_detail::is_full(ctrl_[i]))
+        ++i;
+    return const_iterator(this, i);
+}
+
+/********************************************************************************
+ * end() - const_iterator version
+ * ------------------------------------------------------------------------------
+ * Returns a const_iterator representing the end of the flat_unordered_set.
+ *
+ * Returns:
+ *   - Const iterator representing the past-the-end element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::end() const {
+    return const_iterator(this, capacity_);
+}
+
+/********************************************************************************
+ * cbegin() and cend()
+ * ------------------------------------------------------------------------------
+ * Returns constant iterators to the beginning and end of the flat_unordered_set.
+ *
+ * Returns:
+ *   - cbegin(): Const iterator to the first element.
+ *   - cend(): Const iterator to the past-the-end element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::cbegin() const {
+    return begin();
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::cend() const {
+    return end();
+}
+
+/********************************************************************************
+ * empty
+ * ------------------------------------------------------------------------------
+ * Checks if the flat_unordered_set has no elements.
+ *
+ * Returns:
+ *   - true if empty, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::empty() const {
+    return num_elements == 0;
+}
+
+/********************************************************************************
+ * size
+ * ------------------------------------------------------------------------------
+ * Retrieves the number of elements in the flat_unordered_set.
+ *
+ * Returns:
+ *   - Number of elements stored.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size() const {
+    return num_elements;
+}
+
+/********************************************************************************
+ * bucket_count
+ * ------------------------------------------------------------------------------
+ * Retrieves the number of slots in the table.
+ *
+ * Returns:
+ *   - Current capacity (0 before the first insertion).
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::bucket_count() const {
+    return capacity_;
+}
+
+/********************************************************************************
+ * load_factor
+ * ------------------------------------------------------------------------------
+ * Computes the load factor of the flat_unordered_set.
+ *
+ * Returns:
+ *   - The ratio of num_elements to the number of slots.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+float flat_unordered_set<Key, Hash, KeyEqual, Allocator>::load_factor() const {
+    return capacity_ ? static_cast<float>(num_elements) / capacity_ : 0.0f;
+}
+
+/********************************************************************************
+ * max_load_factor (getter)
+ * ------------------------------------------------------------------------------
+ * Returns the current maximum load factor of the flat_unordered_set.
+ *
+ * Returns:
+ *   - Current max load factor.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+float flat_unordered_set<Key, Hash, KeyEqual, Allocator>::max_load_factor() const {
+    return max_load_factor_;
+}
+
+/********************************************************************************
+ * max_load_factor (setter)
+ * ------------------------------------------------------------------------------
+ * Sets a new maximum load factor and rebuilds the table to honour it. Open
+ * addressing needs free slots to terminate probes, so values above 0.875 are
+ * clamped and non-positive values are ignored.
+ *
+ * Parameters:
+ *   - ml: The new maximum load factor.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::max_load_factor(float ml) {
+    if (!(ml > 0.0f))
+        return;
+    max_load_factor_ = ml < kMaxLoadFactor ? ml : kMaxLoadFactor;
+    if (capacity_) {
+        size_type needed = capacity_for(num_elements);
+        resize(needed > capacity_ ? needed : capacity_);
+    }
+}
+
+/********************************************************************************
+ * clear
+ * ------------------------------------------------------------------------------
+ * Removes all elements from the flat_unordered_set. The table storage is kept
+ * for reuse.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::clear() {
+    if (capacity_ == 0)
+        return;
+    for (size_type i = 0; i < capacity_; ++i) {
+        if (unordered_set_detail::is_full(ctrl_[i]))
+            slot_traits::destroy(alloc, slots_ + i);
+    }
+    std::memset(ctrl_, static_cast<unsigned char>(unordered_set_detail::kEmpty), capacity_ + Group::kWidth);
+    num_elements = 0;
+    growth_left_ = capacity_to_growth(capacity_);
+}
+
+/********************************************************************************
+ * insert (lvalue)
+ * ------------------------------------------------------------------------------
+ * Inserts an element into the flat_unordered_set by copying.
+ * If the key already exists, the insertion is ignored.
+ *
+ * Parameters:
+ *   - value: The value to insert.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted element (or existing element)
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+std::pair<typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::insert(const value_type& value) {
+    auto result = emplace_unique(value, value);
+    return { iterator(this, result.first), result.second };
+}
+
+/********************************************************************************
+ * insert (rvalue)
+ * ------------------------------------------------------------------------------
+ * Inserts an element into the flat_unordered_set by moving.
+ * If the key already exists, the insertion is ignored.
+ *
+ * Parameters:
+ *   - value: The rvalue reference to the value to insert.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+std::pair<typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::insert(value_type&& value) {
+    auto result = emplace_unique(value, std::move(value));
+    return { iterator(this, result.first), result.second };
+}
+
+/********************************************************************************
+ * insert (with hint)
+ * ------------------------------------------------------------------------------
+ * Inserts an element, using hint as a shortcut: if hint already points to an
+ * equal element it is returned without hashing. Otherwise this behaves like
+ * insert(value).
+ *
+ * Parameters:
+ *   - hint: Iterator to a likely equal element, or any valid iterator.
+ *   - value: The value to insert (copied or moved).
+ *
+ * Returns:
+ *   - Iterator to the inserted or existing element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::insert(const_iterator hint, const value_type& value) {
+    return emplace_hint(hint, value);
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::insert(const_iterator hint, value_type&& value) {
+    return emplace_hint(hint, std::move(value));
+}
+
+/********************************************************************************
+ * emplace
+ * ------------------------------------------------------------------------------
+ * Inserts an element constructed in-place into the flat_unordered_set.
+ * A single value_type argument is looked up first and only copied or moved on
+ * a miss. Other argument lists have to be turned into a value before its slot
+ * is known, so they are constructed into a temporary that is moved in on a
+ * miss; use try_emplace to look up by key first.
+ *
+ * Parameters:
+ *   - args: Arguments for constructing a new element.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename... Args>
+std::pair<typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::emplace(Args&&... args) {
+    if constexpr (sizeof...(Args) == 1 && std::conjunction<std::is_same<std::decay_t<Args>, value_type>...>::value) {
+        auto result = emplace_unique(args..., std::forward<Args>(args)...);
+        return { iterator(this, result.first), result.second };
+    }
+    else {
+        value_type temp(std::forward<Args>(args)...);
+        return insert(std::move(temp));
+    }
+}
+
+/********************************************************************************
+ * emplace_hint
+ * ------------------------------------------------------------------------------
+ * Like emplace, but first checks whether hint already points to an element
+ * equal to a single value_type argument, in which case nothing is hashed.
+ *
+ * Parameters:
+ *   - hint: Iterator to a likely equal element, or any valid iterator.
+ *   - args: Arguments for constructing a new element.
+ *
+ * Returns:
+ *   - Iterator to the inserted or existing element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename... Args>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::emplace_hint(const_iterator hint, Args&&... args) {
+    if constexpr (sizeof...(Args) == 1 && std::conjunction<std::is_same<std::decay_t<Args>, value_type>...>::value) {
+        if (hint.container == this && hint.slot_index < capacity_ && key_eq(slots_[hint.slot_index], args...))
+            return iterator(this, hint.slot_index);
+    }
+    return emplace(std::forward<Args>(args)...).first;
+}
+
+/********************************************************************************
+ * try_emplace
+ * ------------------------------------------------------------------------------
+ * Hashes and looks up key first, and constructs the stored value only if key
+ * is absent. With no further arguments the value is built from key itself;
+ * otherwise from args, which must produce a value equal to key. key may be
+ * any type accepted by transparent Hash and KeyEqual.
+ *
+ * Parameters:
+ *   - key: The lookup key.
+ *   - args: Optional arguments for constructing the value.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename... Args, typename>
+std::pair<typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::try_emplace(K&& key, Args&&... args) {
+    std::pair<size_type, bool> result;
+    if constexpr (sizeof...(Args) == 0)
+        result = emplace_unique(key, std::forward<K>(key));
+    else
+        result = emplace_unique(key, std::forward<Args>(args)...);
+    return { iterator(this, result.first), result.second };
+}
+
+/********************************************************************************
+ * erase (by key)
+ * ------------------------------------------------------------------------------
+ * Erases the element corresponding to the specified key. The template overload
+ * accepts any type usable with transparent Hash and KeyEqual.
+ *
+ * Parameters:
+ *   - key: The key of the element to remove.
+ *
+ * Returns:
+ *   - The number of elements removed (0 or 1).
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::erase(const key_type& key) {
+    size_type index = find_index(key, hash_of(key));
+    if (index == capacity_)
+        return 0;
+    erase_at(index);
+    return 1;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::erase(const K& key) {
+    size_type index = find_index(key, hash_of(key));
+    if (index == capacity_)
+        return 0;
+    erase_at(index);
+    return 1;
+}
+
+/********************************************************************************
+ * erase (by const_iterator)
+ * ------------------------------------------------------------------------------
+ * Erases the element at the given const_iterator position. Other elements never
+ * move, so iterators to them stay valid.
+ *
+ * Parameters:
+ *   - pos: Const iterator pointing to the element to erase.
+ *
+ * Returns:
+ *   - Iterator pointing to the element following the erased element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::erase(const_iterator pos) {
+    if (pos.container != this || pos.slot_index >= capacity_)
+        return end();
+    erase_at(pos.slot_index);
+    iterator ret(this, pos.slot_index);
+    return ++ret;
+}
+
+/********************************************************************************
+ * erase (by iterator)
+ * ------------------------------------------------------------------------------
+ * Erases the element at the given iterator position.
+ *
+ * Parameters:
+ *   - pos: Iterator pointing to the element to erase.
+ *
+ * Returns:
+ *   - Iterator pointing to the element following the erased element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::erase(iterator pos) {
+    return erase(const_iterator(pos.container, pos.slot_index));
+}
+
+/********************************************************************************
+ * find (non-const version)
+ * ------------------------------------------------------------------------------
+ * Searches for the element with the given key. The template overload accepts
+ * any type usable with transparent Hash and KeyEqual without building a key_type.
+ *
+ * Parameters:
+ *   - key: The key of the element to find.
+ *
+ * Returns:
+ *   - Iterator pointing to the found element, or end() if not found.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::find(const key_type& key) {
+    return iterator(this, find_index(key, hash_of(key)));
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::find(const K& key) {
+    return iterator(this, find_index(key, hash_of(key)));
+}
+
+/********************************************************************************
+ * find (const version)
+ * ------------------------------------------------------------------------------
+ * Searches for the element with the given key, returning a const_iterator.
+ *
+ * Parameters:
+ *   - key: The key of the element to find.
+ *
+ * Returns:
+ *   - Const iterator pointing to the found element, or end() if not found.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::find(const key_type& key) const {
+    return const_iterator(this, find_index(key, hash_of(key)));
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::find(const K& key) const {
+    return const_iterator(this, find_index(key, hash_of(key)));
+}
+
+/********************************************************************************
+ * count
+ * ------------------------------------------------------------------------------
+ * Counts the elements matching the given key.
+ * Since flat_unordered_set does not allow duplicate keys, this returns 0 or 1.
+ *
+ * Parameters:
+ *   - key: The key to count.
+ *
+ * Returns:
+ *   - 1 if found, 0 otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::count(const key_type& key) const {
+    return find_index(key, hash_of(key)) != capacity_ ? 1 : 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename>
+typename flat_unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
+flat_unordered_set<Key, Hash, KeyEqual, Allocator>::count(const K& key) const {
+    return find_index(key, hash_of(key)) != capacity_ ? 1 : 0;
+}
+
+/********************************************************************************
+ * contains
+ * ------------------------------------------------------------------------------
+ * Checks whether an element equal to key is present.
+ *
+ * Parameters:
+ *   - key: The key to look for; key_type or a transparent lookup type.
+ *
+ * Returns:
+ *   - true if found, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::contains(const key_type& key) const {
+    return find_index(key, hash_of(key)) != capacity_;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename>
+bool flat_unordered_set<Key, Hash, KeyEqual, Allocator>::contains(const K& key) const {
+    return find_index(key, hash_of(key)) != capacity_;
+}
+
+/********************************************************************************
+ * rehash
+ * ------------------------------------------------------------------------------
+ * Grows the table so that it has at least new_bucket_count slots (rounded up to
+ * a power of two) and enough room for the current elements.
+ *
+ * Parameters:
+ *   - new_bucket_count: The desired number of slots.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::rehash(size_type new_bucket_count) {
+    if (new_bucket_count == 0)
+        return;
+    size_type new_capacity = Group::kWidth;
+    while (new_capacity < new_bucket_count)
+        new_capacity *= 2;
+    size_type needed = capacity_for(num_elements);
+    if (needed > new_capacity)
+        new_capacity = needed;
+    if (new_capacity > capacity_)
+        resize(new_capacity);
+}
+
+/********************************************************************************
+ * reserve
+ * ------------------------------------------------------------------------------
+ * Reserves enough slots to hold at least count elements without exceeding the
+ * max load factor.
+ *
+ * Parameters:
+ *   - count: The desired capacity in terms of the number of elements.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::reserve(size_type count) {
+    size_type new_capacity = capacity_for(count);
+    if (new_capacity > capacity_)
+        resize(new_capacity);
+}
+
+/********************************************************************************
+ * swap
+ * ------------------------------------------------------------------------------
+ * Exchanges the contents of two flat_unordered_sets. The allocators are
+ * exchanged only if they propagate on swap; otherwise, as for the standard
+ * containers, they must compare equal.
+ *
+ * Parameters:
+ *   - other: The flat_unordered_set to swap with.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+void flat_unordered_set<Key, Hash, KeyEqual, Allocator>::swap(flat_unordered_set& other) noexcept {
+    using std::swap;
+    swap(ctrl_, other.ctrl_);
+    swap(slots_, other.slots_);
+    swap(capacity_, other.capacity_);
+    swap(num_elements, other.num_elements);
+    swap(growth_left_, other.growth_left_);
+    swap(max_load_factor_, other.max_load_factor_);
+    swap(hash_func, other.hash_func);
+    swap(key_eq, other.key_eq);
+    if constexpr (slot_traits::propagate_on_container_swap::value)
+        swap(alloc, other.alloc);
+}
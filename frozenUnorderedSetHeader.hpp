@@ -0,0 +1,153 @@
+#ifndef FROZEN_UNORDERED_SET_HPP
+#define FROZEN_UNORDERED_SET_HPP
+
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "snapshotFormat.hpp"
+#include "unorderedSetDetail.hpp"
+
+/********************************************************************************
+ * frozen_unordered_set
+ * ------------------------------------------------------------------------------
+ * Read-only set served directly from a snapshot written by
+ * unordered_set::save. The file is memory-mapped and never deserialized:
+ * find, count, contains and iteration read the mapped pages in place, and
+ * opening a snapshot allocates nothing on the heap. The mapping is shared, so
+ * processes that open the same file share its physical pages.
+ *
+ * Elements are trivially copyable keys, read as const Key&, or std::string
+ * keys, read as std::string_view. For string keys, lookups also accept a
+ * std::string_view when Hash is std::hash<std::string>. Hash must produce
+ * the same values as the hasher that wrote the file; a sample of stored
+ * hashes is checked when the file is opened.
+ ********************************************************************************/
+template<
+    typename Key,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>
+>
+class frozen_unordered_set {
+    using key_traits = unordered_set_detail::snapshot_key_traits<Key>;
+    static_assert(key_traits::kind != unordered_set_detail::kUnsupportedKeys,
+                  "frozen_unordered_set needs trivially copyable or std::string keys");
+
+    static constexpr bool kStringKeys = key_traits::kind == unordered_set_detail::kStringKeys;
+
+public:
+    using key_type = Key;
+    using value_type = typename key_traits::view_type;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = typename key_traits::reference;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = frozen_unordered_set::value_type;
+        using difference_type = frozen_unordered_set::difference_type;
+        using pointer = const value_type*;
+        using reference = frozen_unordered_set::reference;
+
+        const_iterator() : container(nullptr), index(0) {}
+
+        reference operator*() const {
+            return container->view.key(index);
+        }
+
+        const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++index;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return container == other.container && index == other.index;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class frozen_unordered_set;
+        const frozen_unordered_set* container;
+        size_type index;
+
+        const_iterator(const frozen_unordered_set* cont, size_type i) : container(cont), index(i) {}
+    };
+
+    using iterator = const_iterator;
+
+private:
+    unordered_set_detail::mapped_file file;
+    unordered_set_detail::snapshot_view<Key> view;
+    size_type num_elements;
+    size_type bucket_mask;
+    hasher hash_func;
+    key_equal key_eq;
+
+    template<typename K>
+    using enable_if_transparent_t = std::enable_if_t<
+        (unordered_set_detail::is_transparent_lookup<Hash, KeyEqual>::value ||
+         (kStringKeys && std::is_same<Hash, std::hash<Key>>::value && std::is_same<K, std::string_view>::value)) &&
+        !std::is_convertible<const K&, const_iterator>::value, int>;
+
+    template<typename K>
+    size_type hash_of(const K& key) const;
+    template<typename K>
+    bool key_matches(reference stored, const K& key) const;
+    template<typename K>
+    size_type locate(const K& key) const;
+    void check_hashes() const;
+
+public:
+    frozen_unordered_set();
+    explicit frozen_unordered_set(const std::string& path, const hasher& hash_func_ = hasher(), const key_equal& equal = key_equal());
+    frozen_unordered_set(frozen_unordered_set&& other) noexcept;
+    frozen_unordered_set& operator=(frozen_unordered_set&& other) noexcept;
+    frozen_unordered_set(const frozen_unordered_set&) = delete;
+    frozen_unordered_set& operator=(const frozen_unordered_set&) = delete;
+
+    void open(const std::string& path);
+    void close();
+    bool is_open() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    size_type size() const;
+    size_type bucket_count() const;
+    float load_factor() const;
+
+    const_iterator find(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    const_iterator find(const K& key) const;
+    size_type count(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    size_type count(const K& key) const;
+    bool contains(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    bool contains(const K& key) const;
+};
+
+#include "frozenUnorderedSetImplementation.tpp"
+
+#endif
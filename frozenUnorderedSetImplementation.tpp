@@ -0,0 +1,338 @@
+#include "frozenUnorderedSetHeader.hpp"
+
+/********************************************************************************
+ * hash_of
+ * ------------------------------------------------------------------------------
+ * Hashes a lookup key the way unordered_set does, so the result can be
+ * compared with the hashes stored in the snapshot. A std::string_view looked
+ * up in a set of std::string keys hashed with std::hash<std::string> uses
+ * std::hash<std::string_view>, which the standard guarantees to agree.
+ *
+ * Parameters:
+ *   - key: The key to hash.
+ *
+ * Returns:
+ *   - The mixed hash value.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+template<typename K>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::size_type
+frozen_unordered_set<Key, Hash, KeyEqual>::hash_of(const K& key) const {
+    if constexpr (kStringKeys && std::is_same<Hash, std::hash<Key>>::value && !std::is_same<K, Key>::value)
+        return unordered_set_detail::mix_hash(std::hash<std::string_view>()(std::string_view(key)));
+    else
+        return unordered_set_detail::mix_hash(hash_func(key));
+}
+
+/********************************************************************************
+ * key_matches
+ * ------------------------------------------------------------------------------
+ * Compares a stored element with a lookup key. String elements are views into
+ * the mapping; with the default std::equal_to they are compared as views, and
+ * a custom KeyEqual must accept std::string_view.
+ *
+ * Parameters:
+ *   - stored: The element in the snapshot.
+ *   - key: The key being looked up.
+ *
+ * Returns:
+ *   - True if they are equal.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+template<typename K>
+bool frozen_unordered_set<Key, Hash, KeyEqual>::key_matches(reference stored, const K& key) const {
+    if constexpr (kStringKeys && std::is_same<KeyEqual, std::equal_to<Key>>::value)
+        return stored == std::string_view(key);
+    else
+        return key_eq(stored, key);
+}
+
+/********************************************************************************
+ * locate
+ * ------------------------------------------------------------------------------
+ * Finds the entry index of a key. The key's bucket is a contiguous run of
+ * entries; their stored hashes are compared first, so key_eq only runs on a
+ * probable match.
+ *
+ * Parameters:
+ *   - key: The key to look for.
+ *
+ * Returns:
+ *   - The entry index, or size() if the key is absent.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+template<typename K>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::size_type
+frozen_unordered_set<Key, Hash, KeyEqual>::locate(const K& key) const {
+    if (num_elements == 0)
+        return num_elements;
+    size_type hash = hash_of(key);
+    size_type bucket = hash & bucket_mask;
+    size_type last = static_cast<size_type>(view.bucket_starts[bucket + 1]);
+    for (size_type i = static_cast<size_type>(view.bucket_starts[bucket]); i < last; ++i) {
+        if (view.hashes[i] == hash && key_matches(view.key(i), key))
+            return i;
+    }
+    return num_elements;
+}
+
+/********************************************************************************
+ * check_hashes
+ * ------------------------------------------------------------------------------
+ * Recomputes the hashes of up to kSnapshotHashSamples entries spread over the
+ * file and compares them with the stored ones, so a snapshot written with a
+ * different hasher is rejected instead of silently missing every lookup.
+ * Skipped for string keys whose hasher can only hash a std::string, since
+ * that would allocate.
+ *
+ * Parameters:
+ *   - None.
+ *
+ * Returns:
+ *   - None. Throws std::runtime_error on a mismatch.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+void frozen_unordered_set<Key, Hash, KeyEqual>::check_hashes() const {
+    constexpr bool can_hash_stored = !kStringKeys || std::is_same<Hash, std::hash<Key>>::value ||
+                                     std::is_invocable<const Hash&, std::string_view>::value;
+    if constexpr (can_hash_stored) {
+        size_type samples = std::min(num_elements, unordered_set_detail::kSnapshotHashSamples);
+        for (size_type s = 0; s < samples; ++s) {
+            size_type i = s * num_elements / samples;
+            if (hash_of(view.key(i)) != view.hashes[i])
+                throw std::runtime_error("unordered_set snapshot was written with a different hasher");
+        }
+    }
+}
+
+/********************************************************************************
+ * Default Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs an empty frozen_unordered_set with no file attached.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+frozen_unordered_set<Key, Hash, KeyEqual>::frozen_unordered_set()
+    : num_elements(0), bucket_mask(0), hash_func(Hash()), key_eq(KeyEqual())
+{
+}
+
+/********************************************************************************
+ * Constructor from a snapshot file
+ * ------------------------------------------------------------------------------
+ * Maps the snapshot at path (see open).
+ *
+ * Parameters:
+ *   - path: Snapshot written by unordered_set::save.
+ *   - hash_func_: Hash function; must match the one used to write the file.
+ *   - equal: Equality function for keys.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+frozen_unordered_set<Key, Hash, KeyEqual>::frozen_unordered_set(const std::string& path,
+                                                                const hasher& hash_func_,
+                                                                const key_equal& equal)
+    : num_elements(0), bucket_mask(0), hash_func(hash_func_), key_eq(equal)
+{
+    open(path);
+}
+
+/********************************************************************************
+ * Move Constructor and Move Assignment
+ * ------------------------------------------------------------------------------
+ * Transfer the mapping; the source is left with no file attached.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+frozen_unordered_set<Key, Hash, KeyEqual>::frozen_unordered_set(frozen_unordered_set&& other) noexcept
+    : file(std::move(other.file)), view(other.view), num_elements(other.num_elements),
+      bucket_mask(other.bucket_mask), hash_func(std::move(other.hash_func)), key_eq(std::move(other.key_eq))
+{
+    other.view = unordered_set_detail::snapshot_view<Key>();
+    other.num_elements = 0;
+    other.bucket_mask = 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+frozen_unordered_set<Key, Hash, KeyEqual>&
+frozen_unordered_set<Key, Hash, KeyEqual>::operator=(frozen_unordered_set&& other) noexcept {
+    if (this != &other) {
+        file = std::move(other.file);
+        view = other.view;
+        num_elements = other.num_elements;
+        bucket_mask = other.bucket_mask;
+        hash_func = std::move(other.hash_func);
+        key_eq = std::move(other.key_eq);
+        other.view = unordered_set_detail::snapshot_view<Key>();
+        other.num_elements = 0;
+        other.bucket_mask = 0;
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * open
+ * ------------------------------------------------------------------------------
+ * Maps a snapshot read-only and validates it (see snapshot_view::validate):
+ * the header, and one pass over the bucket starts and string offsets, so a
+ * damaged file is rejected here rather than read past by a lookup. Nothing is
+ * copied or allocated, and the hashes and keys are only read by the lookups
+ * that touch them. Any previously opened file is closed first.
+ *
+ * Parameters:
+ *   - path: Snapshot written by unordered_set::save.
+ *
+ * Returns:
+ *   - None. Throws std::system_error if the file cannot be mapped and
+ *     std::runtime_error if it is not a valid snapshot for this key type or
+ *     was written with a different hasher; the set is then left closed.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+void frozen_unordered_set<Key, Hash, KeyEqual>::open(const std::string& path) {
+    close();
+    unordered_set_detail::mapped_file mapped(path);
+    auto v = unordered_set_detail::snapshot_view<Key>::validate(mapped.data(), mapped.size());
+    file = std::move(mapped);
+    view = v;
+    num_elements = static_cast<size_type>(v.header->element_count);
+    bucket_mask = static_cast<size_type>(v.header->bucket_count - 1);
+    try {
+        check_hashes();
+    }
+    catch (...) {
+        close();
+        throw;
+    }
+}
+
+/********************************************************************************
+ * close
+ * ------------------------------------------------------------------------------
+ * Unmaps the snapshot. Iterators and references into it become invalid.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+void frozen_unordered_set<Key, Hash, KeyEqual>::close() {
+    file = unordered_set_detail::mapped_file();
+    view = unordered_set_detail::snapshot_view<Key>();
+    num_elements = 0;
+    bucket_mask = 0;
+}
+
+/********************************************************************************
+ * is_open
+ * ------------------------------------------------------------------------------
+ * Returns true if a snapshot is mapped.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+bool frozen_unordered_set<Key, Hash, KeyEqual>::is_open() const {
+    return view.header != nullptr;
+}
+
+/********************************************************************************
+ * begin, end, cbegin and cend
+ * ------------------------------------------------------------------------------
+ * Iterate over the entries in file order, which groups them by bucket.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::const_iterator
+frozen_unordered_set<Key, Hash, KeyEqual>::begin() const {
+    return const_iterator(this, 0);
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::const_iterator
+frozen_unordered_set<Key, Hash, KeyEqual>::end() const {
+    return const_iterator(this, num_elements);
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::const_iterator
+frozen_unordered_set<Key, Hash, KeyEqual>::cbegin() const {
+    return begin();
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::const_iterator
+frozen_unordered_set<Key, Hash, KeyEqual>::cend() const {
+    return end();
+}
+
+/********************************************************************************
+ * empty, size, bucket_count and load_factor
+ * ------------------------------------------------------------------------------
+ * Report the snapshot's element and bucket counts. A closed set is empty and
+ * has no buckets.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+bool frozen_unordered_set<Key, Hash, KeyEqual>::empty() const {
+    return num_elements == 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::size_type
+frozen_unordered_set<Key, Hash, KeyEqual>::size() const {
+    return num_elements;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::size_type
+frozen_unordered_set<Key, Hash, KeyEqual>::bucket_count() const {
+    return is_open() ? bucket_mask + 1 : 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+float frozen_unordered_set<Key, Hash, KeyEqual>::load_factor() const {
+    return is_open() ? static_cast<float>(num_elements) / static_cast<float>(bucket_mask + 1) : 0.0f;
+}
+
+/********************************************************************************
+ * find
+ * ------------------------------------------------------------------------------
+ * Searches for the element with the given key. The template overload accepts
+ * any type usable with transparent Hash and KeyEqual, and std::string_view
+ * for std::string keys with the default hasher.
+ *
+ * Parameters:
+ *   - key: The key to search for.
+ *
+ * Returns:
+ *   - Iterator to the element if found; otherwise, end().
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::const_iterator
+frozen_unordered_set<Key, Hash, KeyEqual>::find(const key_type& key) const {
+    return const_iterator(this, locate(key));
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+template<typename K, typename>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::const_iterator
+frozen_unordered_set<Key, Hash, KeyEqual>::find(const K& key) const {
+    return const_iterator(this, locate(key));
+}
+
+/********************************************************************************
+ * count and contains
+ * ------------------------------------------------------------------------------
+ * Report whether an element with the given key is present.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::size_type
+frozen_unordered_set<Key, Hash, KeyEqual>::count(const key_type& key) const {
+    return locate(key) != num_elements ? 1 : 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+template<typename K, typename>
+typename frozen_unordered_set<Key, Hash, KeyEqual>::size_type
+frozen_unordered_set<Key, Hash, KeyEqual>::count(const K& key) const {
+    return locate(key) != num_elements ? 1 : 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+bool frozen_unordered_set<Key, Hash, KeyEqual>::contains(const key_type& key) const {
+    return locate(key) != num_elements;
+}
+
+template<typename Key, typename Hash, typename KeyEqual>
+template<typename K, typename>
+bool frozen_unordered_set<Key, Hash, KeyEqual>::contains(const K& key) const {
+    return locate(key) != num_elements;
+}
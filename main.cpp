@@ -1,4 +1,49 @@
 #include "unorderedSetHeader.hpp"
+#include "flatUnorderedSetHeader.hpp"
+#include "concurrentUnorderedSetHeader.hpp"
+#include "frozenUnorderedSetHeader.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+struct StringEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const { return a == b; }
+};
+
+// Forwards to the default resource and keeps count of the bytes still held.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t live_bytes() const { return live; }
+
+private:
+    std::size_t live = 0;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        live += bytes;
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        live -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
 
 int main() {
     std::cout << "Testing unordered_set implementation:" << std::endl;
@@ -143,6 +188,296 @@ int main() {
         std::cout << item << " ";
     std::cout << std::endl;
 
+    // -------------------------------
+    // 9. Flat (Open-Addressing) Storage
+    // -------------------------------
+    std::cout << "\nTesting flat_unordered_set:" << std::endl;
+    flat_unordered_set<int> flat = {1, 2, 3, 4, 5};
+    std::cout << "Inserted 6 - Success: " << flat.insert(6).second << std::endl;
+    std::cout << "Inserted duplicate 3 - Success: " << flat.insert(3).second << std::endl;
+    std::cout << "Count for element 4: " << flat.count(4) << std::endl;
+    std::cout << "Erased element 4, count: " << flat.erase(4) << std::endl;
+    auto flatFind = flat.find(5);
+    if (flatFind != flat.end())
+        flat.erase(flatFind);
+    flat_unordered_set<int> flat_copy(flat);
+    std::cout << "Copied flat set (size " << flat_copy.size() << ", slots " << flat_copy.bucket_count() << "):" << std::endl;
+    for (const auto& item : flat_copy)
+        std::cout << item << " ";
+    std::cout << std::endl;
+    {
+        // Unequal allocators that do not propagate: the elements move one by one.
+        using pmr_flat_set = flat_unordered_set<std::pmr::string, std::hash<std::pmr::string>, std::equal_to<std::pmr::string>,
+                                                std::pmr::polymorphic_allocator<std::pmr::string>>;
+        std::pmr::monotonic_buffer_resource source_arena, target_arena;
+        pmr_flat_set source(0, {}, {}, &source_arena), target(0, {}, {}, &target_arena);
+        for (int i = 0; i < 100; ++i)
+            source.insert(std::pmr::string("flat key number " + std::to_string(i)));
+        target = std::move(source);
+        bool kept = target.size() == 100 && source.empty() && target.get_allocator().resource() == &target_arena &&
+                    target.contains(std::pmr::string("flat key number 42"));
+        std::cout << "Moved across arenas, kept own allocator: " << kept << std::endl;
+        if (!kept)
+            return 1;
+    }
+
+    // -------------------------------
+    // 10. Custom Allocator Arena
+    // -------------------------------
+    std::cout << "\nTesting node allocation from a monotonic arena:" << std::endl;
+    std::pmr::monotonic_buffer_resource arena;
+    unordered_set<std::pmr::string, std::hash<std::pmr::string>, std::equal_to<std::pmr::string>,
+                  std::pmr::polymorphic_allocator<std::pmr::string>> arena_set(16, {}, {}, &arena);
+    arena_set.insert(std::pmr::string("alpha"));
+    arena_set.insert(std::pmr::string("beta"));
+    arena_set.erase(std::pmr::string("alpha"));
+    arena_set.insert(std::pmr::string("gamma"));
+    std::cout << "Arena set size: " << arena_set.size()
+              << ", uses arena: " << (arena_set.get_allocator().resource() == &arena ? "Yes" : "No") << std::endl;
+
+    // -------------------------------
+    // 11. Heterogeneous Lookup & Lazy Construction
+    // -------------------------------
+    std::cout << "\nTesting transparent lookup and try_emplace:" << std::endl;
+    unordered_set<std::string, StringHash, StringEqual> names;
+    names.try_emplace(std::string_view("alice"));
+    names.try_emplace("bob");
+    std::cout << "Second try_emplace of bob - Success: " << names.try_emplace("bob").second << std::endl;
+    std::cout << "Contains alice (string_view): " << names.contains(std::string_view("alice")) << std::endl;
+    std::cout << "Count for carol (const char*): " << names.count("carol") << std::endl;
+    auto hinted = names.insert(names.find("bob"), std::string("bob"));
+    std::cout << "Hinted insert of bob returned: " << *hinted << std::endl;
+    std::cout << "Erased bob (string_view), count: " << names.erase(std::string_view("bob")) << std::endl;
+
+    // -------------------------------
+    // 12. Batched Operations
+    // -------------------------------
+    std::cout << "\nTesting insert_range, find_many and erase_many:" << std::endl;
+    std::vector<int> batch_keys = {10, 20, 30, 40, 50};
+    unordered_set<int> batch_set;
+    batch_set.insert_range(batch_keys.begin(), batch_keys.end());
+    std::cout << "Size after insert_range: " << batch_set.size() << std::endl;
+    int batch_probes[] = {10, 15, 30, 99};
+    std::uint64_t found_bits = 0;
+    std::cout << "find_many found " << batch_set.find_many(batch_probes, 4, &found_bits)
+              << " of 4 (bitmap " << found_bits << ")" << std::endl;
+    std::cout << "erase_many removed " << batch_set.erase_many(batch_probes, 4)
+              << ", size now " << batch_set.size() << std::endl;
+    // Forward iterators over another type still reserve once up front.
+    std::vector<short> short_keys;
+    for (short i = 0; i < 1000; ++i)
+        short_keys.push_back(i);
+    batch_set.insert_range(short_keys.begin(), short_keys.end());
+    std::cout << "Size after insert_range of shorts: " << batch_set.size() << std::endl;
+    if (batch_set.size() != 1000 || batch_set.load_factor() > batch_set.max_load_factor())
+        return 1;
+
+    // -------------------------------
+    // 13. Concurrent Set Stress
+    // -------------------------------
+    std::cout << "\nTesting concurrent_unordered_set with several threads:" << std::endl;
+    concurrent_unordered_set<int> shared_set(0, 8);
+    const int kWriters = 4;
+    const int kPerWriter = 20000;
+    for (int i = 0; i < 1000; ++i)
+        shared_set.insert(-1 - i);
+    std::atomic<bool> writers_done{false};
+    std::atomic<int> stable_misses{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kWriters; ++t) {
+        threads.emplace_back([&shared_set, t] {
+            for (int i = 0; i < kPerWriter; ++i) {
+                int key = t * kPerWriter + i;
+                shared_set.insert(key);
+                if (i % 2)
+                    shared_set.erase(key);
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&shared_set, &writers_done, &stable_misses] {
+            // Keys inserted up front must stay visible through every resize.
+            for (int i = 0; !writers_done.load(); i = (i + 1) % 1000) {
+                if (!shared_set.contains(-1 - i))
+                    ++stable_misses;
+            }
+        });
+    }
+    for (int t = 0; t < kWriters; ++t)
+        threads[t].join();
+    writers_done = true;
+    for (std::size_t t = kWriters; t < threads.size(); ++t)
+        threads[t].join();
+    std::cout << "Size after concurrent inserts/erases: " << shared_set.size()
+              << " (expected " << 1000 + kWriters * kPerWriter / 2 << ")" << std::endl;
+    std::cout << "Stable keys missed by readers: " << stable_misses << std::endl;
+    std::cout << "Contains 2: " << shared_set.contains(2) << ", contains 3: " << shared_set.contains(3) << std::endl;
+    shared_set.visit(2, [](const int& v) { std::cout << "Visited element: " << v << std::endl; });
+    // Every writer kept its even keys and erased its odd ones.
+    bool keys_exact = true;
+    for (int key = 0; key < kWriters * kPerWriter; ++key)
+        keys_exact = keys_exact && shared_set.contains(key) == (key % 2 == 0);
+    for (int i = 0; i < 1000; ++i)
+        keys_exact = keys_exact && shared_set.contains(-1 - i);
+    std::cout << "Exactly the even keys and the stable keys present: " << keys_exact << std::endl;
+    if (stable_misses != 0 || shared_set.size() != std::size_t(1000 + kWriters * kPerWriter / 2) || !keys_exact)
+        return 1;
+    // for_each holds no lock while its callback runs, so the callback may erase.
+    std::size_t erased_in_walk = 0;
+    shared_set.for_each([&shared_set, &erased_in_walk](const int& v) {
+        if (v < 0)
+            erased_in_walk += shared_set.erase(v);
+    });
+    std::cout << "Stable keys erased from inside for_each: " << erased_in_walk << std::endl;
+    if (erased_in_walk != 1000 || shared_set.size() != std::size_t(kWriters * kPerWriter / 2))
+        return 1;
+    // Lowering the max load factor grows the shards straight away.
+    shared_set.max_load_factor(0.25f);
+    std::cout << "Load factor after lowering max to 0.25: " << shared_set.load_factor() << std::endl;
+    if (shared_set.load_factor() > 0.25f)
+        return 1;
+    const int present_key = 2;
+    bool emplaced_present = shared_set.emplace(present_key);
+    bool emplaced_new = shared_set.emplace(static_cast<short>(-5));
+    std::cout << "Emplaced existing 2: " << emplaced_present << ", emplaced new -5: " << emplaced_new << std::endl;
+    if (emplaced_present || !emplaced_new || !shared_set.contains(-5))
+        return 1;
+
+    // -------------------------------
+    // 14. Incremental Rehashing
+    // -------------------------------
+    std::cout << "\nTesting incremental rehashing:" << std::endl;
+    unordered_set<int, std::hash<int>, std::equal_to<int>, std::allocator<int>, unordered_set_traits<false, true>> incremental;
+    for (int i = 0; i < 18; ++i)
+        incremental.insert(i);  // The 18th insert starts doubling to 32 buckets.
+    std::cout << "Size: " << incremental.size() << ", load factor: " << incremental.load_factor() << std::endl;
+    int visited = 0;
+    for (auto it = incremental.begin(); it != incremental.end(); ++it) {
+        incremental.insert(*it);  // Existing key: only advances the migration.
+        ++visited;
+    }
+    std::cout << "Visited while migrating: " << visited << std::endl;
+    std::cout << "Contains 17: " << incremental.contains(17) << ", erased 3: " << incremental.erase(3) << std::endl;
+
+    // -------------------------------
+    // 15. Node Handles, Merge and Set Algebra
+    // -------------------------------
+    std::cout << "\nTesting extract, merge and set algebra:" << std::endl;
+    unordered_set<int> left{ 1, 2, 3, 4, 5 };
+    unordered_set<int> right{ 4, 5, 6, 7 };
+    auto handle = left.extract(1);
+    handle.value() = 10;  // Re-key the node without reallocating it.
+    auto placed = right.insert(std::move(handle));
+    std::cout << "Moved 1 as 10: " << placed.inserted << ", right contains 10: " << right.contains(10) << std::endl;
+    std::cout << "Union: " << set_union(left, right).size()
+              << ", intersection: " << set_intersection(left, right, 2).size()
+              << ", difference: " << set_difference(left, right).size() << std::endl;
+    left.merge(right);  // 4 and 5 are already in left, so they stay in right.
+    std::cout << "After merge, left: " << left.size() << ", right: " << right.size() << std::endl;
+
+    // Merging sets whose keys are all present moves nothing, so it must not
+    // keep their memory alive. Merging whole sets into a sliding window must
+    // not pile up their slabs either.
+    using counted_set = unordered_set<int, std::hash<int>, std::equal_to<int>, std::pmr::polymorphic_allocator<int>>;
+    CountingResource merge_memory;
+    counted_set accumulator(16, {}, {}, &merge_memory);
+    for (int i = 0; i < 1000; ++i)
+        accumulator.insert(i);
+    std::size_t settled = 0;
+    for (int batch = 0; batch < 50; ++batch) {
+        {
+            counted_set duplicates(16, {}, {}, &merge_memory);
+            for (int i = 0; i < 1000; ++i)
+                duplicates.insert(i);
+            accumulator.merge(duplicates);
+        }
+        if (batch == 0)
+            settled = merge_memory.live_bytes();
+    }
+    bool merge_flat = merge_memory.live_bytes() == settled;
+    std::size_t window_peak = 0;
+    for (int batch = 1; batch <= 200; ++batch) {
+        counted_set incoming(16, {}, {}, &merge_memory);
+        for (int i = 0; i < 1000; ++i)
+            incoming.insert(batch * 1000 + i);
+        accumulator.merge(incoming);
+        for (int i = 0; i < 1000; ++i)
+            accumulator.erase((batch - 1) * 1000 + i);
+        if (batch == 10)
+            settled = merge_memory.live_bytes();
+        window_peak = std::max(window_peak, merge_memory.live_bytes());
+    }
+    bool bounded = window_peak <= 2 * settled;
+    std::cout << "Memory flat after merging duplicates: " << merge_flat
+              << ", bounded over 200 merged windows: " << bounded << std::endl;
+    if (!merge_flat || !bounded) {
+        std::cout << "merge kept merged sets' memory alive" << std::endl;
+        return 1;
+    }
+
+    // -------------------------------
+    // 16. Snapshots and Frozen Sets
+    // -------------------------------
+    std::cout << "\nTesting snapshots:" << std::endl;
+    unordered_set<std::string> words{ "alpha", "beta", "gamma" };
+    const std::string snapshot_path = "unordered_set_demo.snap";
+    words.save(snapshot_path);
+    unordered_set<std::string> reloaded;
+    reloaded.load(snapshot_path);
+    std::cout << "Reloaded size: " << reloaded.size() << ", contains beta: " << reloaded.contains("beta") << std::endl;
+    frozen_unordered_set<std::string> frozen(snapshot_path);
+    std::cout << "Frozen contains gamma: " << frozen.contains(std::string_view("gamma"))
+              << ", contains delta: " << frozen.contains("delta") << ", elements:";
+    for (std::string_view word : frozen)
+        std::cout << " " << word;
+    std::cout << std::endl;
+    frozen.close();
+    std::remove(snapshot_path.c_str());
+
+    // -------------------------------
+    // 17. Statistics and Event Counters
+    // -------------------------------
+    std::cout << "\nTesting stats and event counters:" << std::endl;
+    unordered_set<int, std::hash<int>, std::equal_to<int>, std::allocator<int>, unordered_set_traits<false, false, true>> counted;
+    for (int i = 0; i < 1000; ++i)
+        counted.insert(i);
+    counted.reset_counters();
+    for (int i = 0; i < 2000; ++i)
+        (void)counted.contains(i);
+    unordered_set_counters events = counted.counters();
+    std::cout << "Lookups: " << events.lookups << ", probes per lookup: "
+              << static_cast<double>(events.probes) / events.lookups
+              << ", key comparisons: " << events.key_comparisons << std::endl;
+    unordered_set_stats table = counted.stats();
+    std::cout << "Buckets: " << table.bucket_count << ", empty: " << table.empty_bucket_ratio * 100
+              << "%, longest chain: " << table.longest_chain << std::endl;
+    std::cout << "Bucket bytes: " << table.bucket_bytes << ", node bytes: " << table.node_bytes
+              << " (" << table.node_bytes_in_use << " in use)" << std::endl;
+
+    // -------------------------------
+    // 18. Sparse Tables and Shrinking
+    // -------------------------------
+    std::cout << "\nTesting iteration and shrinking of a sparse table:" << std::endl;
+    unordered_set<int> sparse;
+    for (int i = 0; i < 100000; ++i)
+        sparse.insert(i);
+    for (int i = 5; i < 100000; ++i)
+        sparse.erase(i);
+    std::cout << "Buckets after erasing: " << sparse.stats().bucket_count << ", elements in insertion order:";
+    for (int v : sparse)
+        std::cout << " " << v;  // Visits the 5 survivors, not 131072 buckets.
+    std::cout << std::endl;
+    sparse.shrink_to_fit();
+    std::cout << "Buckets after shrink_to_fit: " << sparse.stats().bucket_count << std::endl;
+    unordered_set<int> self_shrinking;
+    self_shrinking.min_load_factor(0.25f);
+    for (int i = 0; i < 100000; ++i)
+        self_shrinking.insert(i);
+    for (int i = 0; i < 99990; ++i)
+        self_shrinking.erase(i);
+    std::cout << "Buckets with min_load_factor 0.25: " << self_shrinking.stats().bucket_count
+              << ", load factor: " << self_shrinking.load_factor() << std::endl;
+
     std::cout << "\nAll tests completed successfully." << std::endl;
     return 0;
 }
@@ -0,0 +1,398 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace unordered_set_detail {
+
+/********************************************************************************
+ * node_pool
+ * ------------------------------------------------------------------------------
+ * Fixed-size block pool used by the chained containers for their nodes. Blocks
+ * are carved out of slabs obtained from the container's Allocator (rebound to
+ * the block type), so a custom arena such as a std::pmr monotonic buffer
+ * receives every node allocation. Freed blocks go onto an intrusive free list
+ * and are handed out again before any new slab is requested. Slabs grow
+ * geometrically up to kMaxSlabBytes and are only returned to the allocator
+ * all at once.
+ *
+ * Slabs belong to a reference-counted slab group rather than to the pool
+ * itself, so that nodes can be spliced between containers. When a pool
+ * receives nodes carved from another pool's slabs it joins that pool's group
+ * (join), and the group's slabs then live until every pool and node handle
+ * referring to it is gone. Groups are merged union-find style: a group that
+ * is joined into another hands over its slabs and keeps its new root alive,
+ * so group references never form a cycle. Pools of different containers can
+ * end up sharing a root, so the slab lists and parent links are only changed
+ * under a mutex; that happens once per slab and once per join, never per
+ * block.
+ *
+ * The pool hands out raw storage; constructing and destroying the T objects
+ * is the caller's job.
+ ********************************************************************************/
+template<typename T, typename Allocator>
+class node_pool {
+    union block {
+        block* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct slab_header {
+        block* next_slab;
+        std::size_t block_count;
+    };
+
+    using block_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+    using block_traits = std::allocator_traits<block_allocator_type>;
+
+    static slab_header* header_of(block* slab) {
+        return std::launder(reinterpret_cast<slab_header*>(slab));
+    }
+
+    struct slab_group {
+        block_allocator_type block_alloc;
+        block* slabs;
+        // Bytes of the slabs listed in slabs, which include those of groups
+        // joined into this one.
+        std::size_t bytes;
+        std::shared_ptr<slab_group> parent;
+
+        explicit slab_group(const block_allocator_type& alloc) : block_alloc(alloc), slabs(nullptr), bytes(0) {}
+
+        ~slab_group() {
+            while (slabs) {
+                block* slab = slabs;
+                slab_header* header = header_of(slab);
+                slabs = header->next_slab;
+                block_traits::deallocate(block_alloc, slab, header->block_count);
+            }
+        }
+
+        slab_group(const slab_group&) = delete;
+        slab_group& operator=(const slab_group&) = delete;
+    };
+
+public:
+    // Keeps a pool's slabs alive, e.g. inside a node handle.
+    using slab_ref = std::shared_ptr<slab_group>;
+
+private:
+    static constexpr std::size_t kHeaderBlocks = (sizeof(slab_header) + sizeof(block) - 1) / sizeof(block);
+    static constexpr std::size_t kFirstSlabBlocks = 32;
+    static constexpr std::size_t kMaxSlabBytes = 64 * 1024;
+
+    block_allocator_type block_alloc;
+    slab_ref group;
+    block* free_list;
+    block* bump;
+    block* bump_end;
+    std::size_t next_slab_blocks;
+    std::size_t slab_bytes_;
+    std::size_t free_blocks_;
+    std::size_t trim_floor_;
+
+    static std::mutex& structure_mutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    // Callers hold structure_mutex().
+    static slab_ref root_of(slab_ref g) {
+        while (g->parent)
+            g = g->parent;
+        return g;
+    }
+
+    void add_slab() {
+        if (!group) {
+            using group_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<slab_group>;
+            group = std::allocate_shared<slab_group>(group_allocator_type(block_alloc), block_alloc);
+        }
+        std::size_t count = kHeaderBlocks + next_slab_blocks;
+        block* slab = block_traits::allocate(block_alloc, count);
+        slab_bytes_ += count * sizeof(block);
+        {
+            std::lock_guard<std::mutex> lock(structure_mutex());
+            slab_ref root = root_of(group);
+            ::new (static_cast<void*>(slab)) slab_header{ root->slabs, count };
+            root->slabs = slab;
+            root->bytes += count * sizeof(block);
+        }
+        bump = slab + kHeaderBlocks;
+        bump_end = slab + count;
+        if ((next_slab_blocks * 2 + kHeaderBlocks) * sizeof(block) <= kMaxSlabBytes)
+            next_slab_blocks *= 2;
+    }
+
+    void reset() {
+        free_list = nullptr;
+        bump = nullptr;
+        bump_end = nullptr;
+        next_slab_blocks = kFirstSlabBlocks;
+        slab_bytes_ = 0;
+        free_blocks_ = 0;
+        trim_floor_ = 0;
+    }
+
+    void steal(node_pool& other) {
+        group = std::move(other.group);
+        free_list = other.free_list;
+        bump = other.bump;
+        bump_end = other.bump_end;
+        next_slab_blocks = other.next_slab_blocks;
+        slab_bytes_ = other.slab_bytes_;
+        free_blocks_ = other.free_blocks_;
+        trim_floor_ = other.trim_floor_;
+        other.reset();
+    }
+
+public:
+    explicit node_pool(const Allocator& alloc = Allocator())
+        : block_alloc(alloc) {
+        reset();
+    }
+
+    // Copies share nothing but the allocator; the new pool starts empty.
+    node_pool(const node_pool& other)
+        : block_alloc(block_traits::select_on_container_copy_construction(other.block_alloc)) {
+        reset();
+    }
+
+    node_pool(node_pool&& other) noexcept
+        : block_alloc(std::move(other.block_alloc)) {
+        steal(other);
+    }
+
+    // Releases every slab; the allocator follows other only if it propagates.
+    node_pool& operator=(const node_pool& other) {
+        if (this != &other) {
+            release();
+            if constexpr (block_traits::propagate_on_container_copy_assignment::value)
+                block_alloc = other.block_alloc;
+        }
+        return *this;
+    }
+
+    // Takes over other's slabs. Requires can_adopt(other).
+    node_pool& operator=(node_pool&& other) noexcept {
+        if (this != &other) {
+            release();
+            if constexpr (block_traits::propagate_on_container_move_assignment::value)
+                block_alloc = std::move(other.block_alloc);
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~node_pool() {
+        release();
+    }
+
+    Allocator get_allocator() const {
+        return Allocator(block_alloc);
+    }
+
+    // True when memory from other's slabs may later be freed through this pool.
+    bool can_adopt(const node_pool& other) const {
+        return block_traits::propagate_on_container_move_assignment::value ||
+               block_alloc == other.block_alloc;
+    }
+
+    T* allocate() {
+        block* b;
+        if (free_list) {
+            b = free_list;
+            free_list = free_list->next;
+            --free_blocks_;
+        }
+        else {
+            if (bump == bump_end)
+                add_slab();
+            b = bump++;
+        }
+        return reinterpret_cast<T*>(b->storage);
+    }
+
+    void deallocate(T* p) noexcept {
+        block* b = reinterpret_cast<block*>(p);
+        b->next = free_list;
+        free_list = b;
+        ++free_blocks_;
+    }
+
+    // Drops this pool's slabs, returning them to the allocator unless another
+    // pool or node handle still shares them. The pool's own objects must
+    // already be destroyed.
+    void release() noexcept {
+        group.reset();
+        reset();
+    }
+
+    // Bytes of the slabs this pool has requested itself since it was last
+    // released; grows exactly when allocate() had to get a new slab.
+    std::size_t requested_bytes() const {
+        return slab_bytes_;
+    }
+
+    // Bytes of all the slabs this pool's nodes may live in: its own, and
+    // those of every pool it shares a slab group with through join. Pools in
+    // one group all report the same total.
+    std::size_t slab_bytes() const {
+        if (!group)
+            return 0;
+        std::lock_guard<std::mutex> lock(structure_mutex());
+        return root_of(group)->bytes;
+    }
+
+    slab_ref share() const {
+        return group;
+    }
+
+    static Allocator allocator_of(const slab_ref& ref) {
+        return Allocator(ref->block_alloc);
+    }
+
+    // Joins the slab group of nodes this pool is about to take over, so their
+    // storage outlives the pool they came from. The allocators must compare equal.
+    void join(const slab_ref& other) {
+        if (!other)
+            return;
+        if (!group) {
+            group = other;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(structure_mutex());
+        slab_ref root = root_of(group);
+        slab_ref other_root = root_of(other);
+        if (root == other_root)
+            return;
+        if (other_root->slabs) {
+            block* last = other_root->slabs;
+            while (header_of(last)->next_slab)
+                last = header_of(last)->next_slab;
+            header_of(last)->next_slab = root->slabs;
+            root->slabs = other_root->slabs;
+            other_root->slabs = nullptr;
+        }
+        root->bytes += other_root->bytes;
+        other_root->bytes = 0;
+        other_root->parent = root;
+    }
+
+    // Takes over the free blocks and unused slab space of other, which holds
+    // no objects any more and has been joined with this pool, e.g. a set
+    // whose every node was merged into this one. other is left empty and no
+    // longer refers to the shared slabs.
+    void adopt_free_blocks(node_pool& other) {
+        while (other.free_list) {
+            block* b = other.free_list;
+            other.free_list = b->next;
+            b->next = free_list;
+            free_list = b;
+            ++free_blocks_;
+        }
+        for (block* b = other.bump; b != other.bump_end; ++b) {
+            b->next = free_list;
+            free_list = b;
+            ++free_blocks_;
+        }
+        other.release();
+    }
+
+    // Returns the slabs none of whose blocks are in use to the allocator.
+    // Blocks that came from other pools never return to them, so a pool that
+    // keeps receiving nodes through merges would otherwise hoard their
+    // slabs. Only done while this pool is the sole owner of its slabs, and
+    // only once the spare blocks outnumber the live ones and have doubled
+    // since the last trim, so the O(spare blocks + slabs) scan is amortized.
+    void trim(std::size_t live_blocks) {
+        std::size_t spare = free_blocks_ + static_cast<std::size_t>(bump_end - bump);
+        if (spare <= live_blocks || spare <= 2 * trim_floor_ || !group || group->parent ||
+            group.use_count() != 1)
+            return;
+
+        struct slab_use {
+            block* start;
+            std::size_t free;
+        };
+        std::vector<slab_use> slabs;
+        for (block* slab = group->slabs; slab; slab = header_of(slab)->next_slab)
+            slabs.push_back({ slab, 0 });
+        std::less<block*> before;
+        std::sort(slabs.begin(), slabs.end(), [&](const slab_use& a, const slab_use& b) {
+            return before(a.start, b.start);
+        });
+        auto slab_of = [&](block* b) {
+            auto it = std::upper_bound(slabs.begin(), slabs.end(), b, [&](block* p, const slab_use& slab) {
+                return before(p, slab.start);
+            });
+            return std::prev(it);
+        };
+        auto empty = [](const slab_use& slab) {
+            return slab.free == header_of(slab.start)->block_count - kHeaderBlocks;
+        };
+
+        for (block* b = free_list; b; b = b->next)
+            ++slab_of(b)->free;
+        if (bump != bump_end)
+            slab_of(bump)->free += static_cast<std::size_t>(bump_end - bump);
+        trim_floor_ = spare;
+        if (std::none_of(slabs.begin(), slabs.end(), empty))
+            return;
+
+        block** link = &free_list;
+        while (*link) {
+            if (empty(*slab_of(*link))) {
+                *link = (*link)->next;
+                --free_blocks_;
+            }
+            else {
+                link = &(*link)->next;
+            }
+        }
+        if (bump != bump_end && empty(*slab_of(bump))) {
+            bump = nullptr;
+            bump_end = nullptr;
+        }
+        group->slabs = nullptr;
+        for (auto it = slabs.rbegin(); it != slabs.rend(); ++it) {
+            slab_header* header = header_of(it->start);
+            if (empty(*it)) {
+                std::size_t bytes = header->block_count * sizeof(block);
+                slab_bytes_ -= std::min(slab_bytes_, bytes);
+                group->bytes -= bytes;
+                block_traits::deallocate(group->block_alloc, it->start, header->block_count);
+            }
+            else {
+                header->next_slab = group->slabs;
+                group->slabs = it->start;
+            }
+        }
+        trim_floor_ = free_blocks_ + static_cast<std::size_t>(bump_end - bump);
+    }
+
+    void swap(node_pool& other) noexcept {
+        using std::swap;
+        if constexpr (block_traits::propagate_on_container_swap::value)
+            swap(block_alloc, other.block_alloc);
+        swap(group, other.group);
+        swap(free_list, other.free_list);
+        swap(bump, other.bump);
+        swap(bump_end, other.bump_end);
+        swap(next_slab_blocks, other.next_slab_blocks);
+        swap(slab_bytes_, other.slab_bytes_);
+        swap(free_blocks_, other.free_blocks_);
+        swap(trim_floor_, other.trim_floor_);
+    }
+};
+
+} // namespace unordered_set_detail
+
+#endif
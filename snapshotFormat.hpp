@@ -0,0 +1,369 @@
+#ifndef SNAPSHOT_FORMAT_HPP
+#define SNAPSHOT_FORMAT_HPP
+
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace unordered_set_detail {
+
+/********************************************************************************
+ * Snapshot file layout
+ * ------------------------------------------------------------------------------
+ * unordered_set::save writes, and unordered_set::load and frozen_unordered_set
+ * read, one file made of a fixed header followed by 64-byte aligned sections:
+ *
+ *   bucket starts  uint64[bucket_count + 1]: index of the first entry of each
+ *                  bucket; the entries of bucket b are [start[b], start[b+1]).
+ *   hashes         uint64[element_count]: mixed hash of each entry.
+ *   keys           Key[element_count] for trivially copyable keys, or
+ *                  uint64[element_count + 1] offsets into the character
+ *                  section for string keys.
+ *   characters     The bytes of all string keys, back to back.
+ *
+ * Entries are grouped by bucket, so a lookup reads one pair of bucket starts
+ * and then a short contiguous run of hashes. Everything is stored in host
+ * byte order; byte_order detects a file written on a different host.
+ * The hashing itself is unseeded (mix_hash of the user's hash). A file written
+ * with a different hasher is caught by recomputing the hashes of a sample of
+ * entries when it is opened.
+ ********************************************************************************/
+constexpr char kSnapshotMagic[8] = { 'U', 'S', 'E', 'T', 'S', 'N', 'A', 'P' };
+constexpr std::uint32_t kSnapshotVersion = 1;
+constexpr std::uint64_t kSnapshotByteOrder = 0x0102030405060708ULL;
+constexpr std::size_t kSnapshotAlignment = 64;
+constexpr std::size_t kSnapshotHashSamples = 16;
+
+enum snapshot_key_kind : std::uint32_t {
+    kUnsupportedKeys = 0,
+    kTrivialKeys = 1,
+    kStringKeys = 2
+};
+
+struct snapshot_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t key_kind;
+    std::uint32_t key_size;
+    std::uint32_t key_align;
+    std::uint64_t byte_order;
+    std::uint64_t element_count;
+    std::uint64_t bucket_count;
+    std::uint64_t bucket_offset;
+    std::uint64_t hash_offset;
+    std::uint64_t key_offset;
+    std::uint64_t char_offset;
+    std::uint64_t file_size;
+    float max_load_factor;
+    std::uint32_t reserved;
+};
+
+/********************************************************************************
+ * snapshot_key_traits
+ * ------------------------------------------------------------------------------
+ * How a key type is stored in a snapshot. Trivially copyable keys are stored
+ * as their bytes and read back in place; std::string keys are stored as
+ * offsets into a character section and read back as std::string_view. Other
+ * key types cannot be saved.
+ ********************************************************************************/
+template<typename Key>
+struct snapshot_key_traits {
+    static constexpr std::uint32_t kind = std::is_trivially_copyable<Key>::value ? kTrivialKeys : kUnsupportedKeys;
+    static constexpr std::uint32_t size = sizeof(Key);
+    static constexpr std::uint32_t align = alignof(Key);
+    using view_type = Key;
+    using reference = const Key&;
+};
+
+template<typename Alloc>
+struct snapshot_key_traits<std::basic_string<char, std::char_traits<char>, Alloc>> {
+    static constexpr std::uint32_t kind = kStringKeys;
+    static constexpr std::uint32_t size = sizeof(char);
+    static constexpr std::uint32_t align = alignof(char);
+    using view_type = std::string_view;
+    using reference = std::string_view;
+};
+
+inline std::uint64_t snapshot_align(std::uint64_t offset) {
+    return (offset + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+}
+
+/********************************************************************************
+ * mapped_file
+ * ------------------------------------------------------------------------------
+ * Read-only, shared memory mapping of a whole file. Pages come straight from
+ * the page cache, so every process mapping the same file shares one physical
+ * copy. Move-only; the mapping is removed on destruction.
+ ********************************************************************************/
+class mapped_file {
+public:
+    mapped_file() = default;
+
+    explicit mapped_file(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "cannot open snapshot " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "cannot stat snapshot " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "cannot map snapshot " + path);
+            }
+            data_ = static_cast<const unsigned char*>(p);
+        }
+        ::close(fd);
+    }
+
+    mapped_file(mapped_file&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_file() {
+        unmap();
+    }
+
+    const unsigned char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+private:
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    void unmap() noexcept {
+        if (data_)
+            ::munmap(const_cast<unsigned char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+};
+
+/********************************************************************************
+ * snapshot_view
+ * ------------------------------------------------------------------------------
+ * Typed pointers into a validated snapshot image. validate() checks the
+ * header: magic, version, byte order, key layout, a power-of-two bucket
+ * count, a positive max load factor and that every section lies inside the
+ * image. It then walks the bucket starts, and the string offsets for string
+ * keys, once, checking that they never decrease and stay in range, so no
+ * lookup or key() can reach past the image however the file was damaged.
+ * That reads O(buckets + string keys) words but allocates nothing. The hashes
+ * and key bytes themselves are not checked.
+ ********************************************************************************/
+template<typename Key>
+struct snapshot_view {
+    using traits = snapshot_key_traits<Key>;
+
+    const snapshot_header* header = nullptr;
+    const std::uint64_t* bucket_starts = nullptr;
+    const std::uint64_t* hashes = nullptr;
+    const unsigned char* keys = nullptr;
+    const char* chars = nullptr;
+
+    [[noreturn]] static void fail(const char* what) {
+        throw std::runtime_error(std::string("invalid unordered_set snapshot: ") + what);
+    }
+
+    static snapshot_view validate(const unsigned char* data, std::size_t size) {
+        if (size < sizeof(snapshot_header))
+            fail("file too small");
+        const snapshot_header* h = reinterpret_cast<const snapshot_header*>(data);
+        if (std::memcmp(h->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0)
+            fail("bad magic");
+        if (h->version != kSnapshotVersion)
+            fail("unsupported version");
+        if (h->byte_order != kSnapshotByteOrder)
+            fail("written with a different byte order");
+        if (h->key_kind != traits::kind || h->key_size != traits::size || h->key_align != traits::align)
+            fail("key type does not match");
+        if (h->file_size != size)
+            fail("truncated file");
+        if (h->bucket_count == 0 || (h->bucket_count & (h->bucket_count - 1)) != 0)
+            fail("bucket count is not a power of two");
+        if (!(h->max_load_factor > 0.0f) || !std::isfinite(h->max_load_factor))
+            fail("max load factor is not a positive number");
+
+        auto section_fits = [size](std::uint64_t offset, std::uint64_t count, std::uint64_t width) {
+            return offset % kSnapshotAlignment == 0 && offset <= size &&
+                   count <= (size - offset) / width;
+        };
+        std::uint64_t n = h->element_count;
+        if (!section_fits(h->bucket_offset, h->bucket_count + 1, sizeof(std::uint64_t)) ||
+            !section_fits(h->hash_offset, n, sizeof(std::uint64_t)))
+            fail("section out of range");
+        if (traits::kind == kStringKeys) {
+            if (!section_fits(h->key_offset, n + 1, sizeof(std::uint64_t)) || h->char_offset > size)
+                fail("section out of range");
+        }
+        else if (!section_fits(h->key_offset, n, traits::size)) {
+            fail("section out of range");
+        }
+
+        snapshot_view v;
+        v.header = h;
+        v.bucket_starts = reinterpret_cast<const std::uint64_t*>(data + h->bucket_offset);
+        v.hashes = reinterpret_cast<const std::uint64_t*>(data + h->hash_offset);
+        v.keys = data + h->key_offset;
+        v.chars = reinterpret_cast<const char*>(data + h->char_offset);
+        if (v.bucket_starts[h->bucket_count] != n)
+            fail("bucket starts do not match element count");
+        if (traits::kind == kStringKeys &&
+            reinterpret_cast<const std::uint64_t*>(v.keys)[n] > size - h->char_offset)
+            fail("string section out of range");
+        v.check_offsets();
+        return v;
+    }
+
+    // The last bucket start and string offset were range-checked above, so
+    // offsets that never decrease are all in range.
+    void check_offsets() const {
+        for (std::uint64_t b = 0; b < header->bucket_count; ++b) {
+            if (bucket_starts[b] > bucket_starts[b + 1])
+                fail("bucket starts decrease");
+        }
+        if constexpr (traits::kind == kStringKeys) {
+            const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(keys);
+            for (std::uint64_t i = 0; i < header->element_count; ++i) {
+                if (offsets[i] > offsets[i + 1])
+                    fail("string offsets decrease");
+            }
+        }
+    }
+
+    typename traits::reference key(std::size_t i) const {
+        if constexpr (traits::kind == kStringKeys) {
+            const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(keys);
+            return std::string_view(chars + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i]));
+        }
+        else {
+            return *std::launder(reinterpret_cast<const Key*>(keys + i * sizeof(Key)));
+        }
+    }
+};
+
+/********************************************************************************
+ * snapshot_writer
+ * ------------------------------------------------------------------------------
+ * Sequential writer for a snapshot. Most fields are single words, so writes
+ * are gathered in a buffer before they reach the stream. The file is written
+ * under a temporary name and renamed over the target by commit(), so a
+ * process mapping the old snapshot keeps a consistent image and readers
+ * never see a partial file.
+ ********************************************************************************/
+class snapshot_writer {
+public:
+    explicit snapshot_writer(const std::string& path)
+        : target(path), temporary(path + ".tmp"), out(temporary, std::ios::binary | std::ios::trunc), offset(0),
+          buffer(new char[kBufferSize]) {
+        if (!out)
+            throw std::system_error(errno, std::generic_category(), "cannot create snapshot " + temporary);
+    }
+
+    ~snapshot_writer() {
+        if (out.is_open()) {
+            out.close();
+            std::remove(temporary.c_str());
+        }
+    }
+
+    std::uint64_t position() const { return offset; }
+
+    void write(const void* data, std::size_t size) {
+        if (used + size > kBufferSize) {
+            flush();
+            if (size > kBufferSize) {
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                offset += size;
+                return;
+            }
+        }
+        std::memcpy(buffer.get() + used, data, size);
+        used += size;
+        offset += size;
+    }
+
+    template<typename T>
+    void write_value(const T& value) {
+        write(&value, sizeof(T));
+    }
+
+    // Pads with zero bytes up to the next section boundary; returns it.
+    std::uint64_t align() {
+        static const char zeros[kSnapshotAlignment] = {};
+        write(zeros, static_cast<std::size_t>(snapshot_align(offset) - offset));
+        return offset;
+    }
+
+    void rewrite_header(const snapshot_header& header) {
+        flush();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    void commit() {
+        flush();
+        out.close();
+        if (out.fail())
+            throw std::runtime_error("cannot write snapshot " + temporary);
+        if (std::rename(temporary.c_str(), target.c_str()) != 0) {
+            int err = errno;
+            std::remove(temporary.c_str());
+            throw std::system_error(err, std::generic_category(), "cannot replace snapshot " + target);
+        }
+    }
+
+    snapshot_writer(const snapshot_writer&) = delete;
+    snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+private:
+    std::string target;
+    std::string temporary;
+    std::ofstream out;
+    std::uint64_t offset;
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+    std::unique_ptr<char[]> buffer;
+    std::size_t used = 0;
+
+    void flush() {
+        out.write(buffer.get(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+};
+
+} // namespace unordered_set_detail
+
+#endif
@@ -0,0 +1,497 @@
+#ifndef UNORDERED_SET_DETAIL_HPP
+#define UNORDERED_SET_DETAIL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace unordered_set_detail {
+
+/********************************************************************************
+ * mix_hash
+ * ------------------------------------------------------------------------------
+ * Scrambles a user-supplied hash so that every output bit depends on every
+ * input bit (the MurmurHash3 64-bit finalizer). Weak hashes such as the
+ * identity std::hash<int> would otherwise leave the low bits, which select the
+ * bucket or probe position, badly distributed.
+ *
+ * Parameters:
+ *   - h: The hash value produced by the user's hasher.
+ *
+ * Returns:
+ *   - The mixed hash value.
+ ********************************************************************************/
+inline std::size_t mix_hash(std::size_t h) noexcept {
+    std::uint64_t x = static_cast<std::uint64_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<std::size_t>(x);
+}
+
+/********************************************************************************
+ * prefetch
+ * ------------------------------------------------------------------------------
+ * Hints the CPU to start loading the cache line holding p. Used by the batched
+ * operations to overlap the memory latency of many independent lookups.
+ * Compiles to nothing on compilers without a prefetch builtin.
+ *
+ * Parameters:
+ *   - p: Address that will be read soon.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+inline void prefetch(const void* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+/********************************************************************************
+ * next_power_of_two
+ * ------------------------------------------------------------------------------
+ * Rounds n up to a power of two so that a bucket index can be taken with a
+ * mask instead of a division.
+ *
+ * Parameters:
+ *   - n: The requested count.
+ *
+ * Returns:
+ *   - The smallest power of two not less than n (1 for n == 0).
+ ********************************************************************************/
+inline std::size_t next_power_of_two(std::size_t n) noexcept {
+    std::size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+/********************************************************************************
+ * bucket_array
+ * ------------------------------------------------------------------------------
+ * Fixed-size owning array of bucket heads. Unlike std::vector it can be
+ * allocated without initializing its elements, which lets an incremental
+ * rehash obtain a large bucket array in O(1): each new bucket is written when
+ * the old bucket that feeds it is migrated, and never read before that.
+ ********************************************************************************/
+template<typename T>
+class bucket_array {
+    static_assert(std::is_trivially_copyable<T>::value, "bucket_array holds trivially copyable heads");
+
+    std::unique_ptr<T[]> data_;
+    std::size_t size_ = 0;
+
+public:
+    bucket_array() = default;
+
+    bucket_array(bucket_array&& other) noexcept
+        : data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) {}
+
+    bucket_array& operator=(bucket_array&& other) noexcept {
+        data_ = std::move(other.data_);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+
+    static bucket_array uninitialized(std::size_t n) {
+        bucket_array a;
+        a.data_.reset(new T[n]);
+        a.size_ = n;
+        return a;
+    }
+
+    void assign(std::size_t n, T value) {
+        if (n != size_) {
+            data_.reset(new T[n]);
+            size_ = n;
+        }
+        std::fill(begin(), end(), value);
+    }
+
+    void clear() noexcept {
+        data_.reset();
+        size_ = 0;
+    }
+
+    void swap(bucket_array& other) noexcept {
+        data_.swap(other.data_);
+        std::swap(size_, other.size_);
+    }
+
+    T& operator[](std::size_t i) { return data_[i]; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* begin() { return data_.get(); }
+    T* end() { return data_.get() + size_; }
+};
+
+/********************************************************************************
+ * chunked_array
+ * ------------------------------------------------------------------------------
+ * Growable array kept in fixed chunks of kChunkSize entries, reached through a
+ * directory of chunk pointers. Growing allocates one more chunk and never
+ * moves the entries, so unlike std::vector no single push copies the whole
+ * array; only the directory, kChunkSize times smaller, grows geometrically.
+ * Entries can also be popped from the front, which shifts the indices of the
+ * rest down by one. A front chunk emptied that way is moved to the back and
+ * reused.
+ ********************************************************************************/
+template<typename T>
+class chunked_array {
+    static_assert(std::is_trivially_copyable<T>::value, "chunked_array holds trivially copyable entries");
+
+    static constexpr std::size_t kChunkShift = 9;
+    static constexpr std::size_t kChunkSize = std::size_t(1) << kChunkShift;
+
+    std::vector<std::unique_ptr<T[]>> chunks_;
+    // Index of entry 0 in the first chunk.
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+
+public:
+    chunked_array() = default;
+
+    chunked_array(chunked_array&& other) noexcept
+        : chunks_(std::move(other.chunks_)), head_(std::exchange(other.head_, 0)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    chunked_array& operator=(chunked_array&& other) noexcept {
+        chunks_ = std::move(other.chunks_);
+        head_ = std::exchange(other.head_, 0);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+
+    // Makes room for n entries in all, so that pushing up to that size cannot
+    // throw.
+    void reserve(std::size_t n) {
+        std::size_t needed = (head_ + n + kChunkSize - 1) >> kChunkShift;
+        while (chunks_.size() < needed) {
+            std::unique_ptr<T[]> chunk(new T[kChunkSize]);
+            chunks_.push_back(std::move(chunk));
+        }
+    }
+
+    void push_back(T value) {
+        if (((head_ + size_) >> kChunkShift) == chunks_.size())
+            reserve(size_ + 1);
+        ++size_;
+        back() = value;
+    }
+
+    void pop_back() {
+        if (--size_ == 0)
+            head_ = 0;
+    }
+
+    void pop_front() {
+        if (++head_ == kChunkSize) {
+            std::rotate(chunks_.begin(), chunks_.begin() + 1, chunks_.end());
+            head_ = 0;
+        }
+        if (--size_ == 0)
+            head_ = 0;
+    }
+
+    // Drops the entries from index n on; n must not exceed size().
+    void truncate(std::size_t n) {
+        size_ = n;
+        if (n == 0)
+            head_ = 0;
+    }
+
+    // Empties the array but keeps its chunks, like std::vector::clear.
+    void clear() noexcept {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    void shrink_to_fit() {
+        chunks_.resize((head_ + size_ + kChunkSize - 1) >> kChunkShift);
+        chunks_.shrink_to_fit();
+    }
+
+    T& operator[](std::size_t i) {
+        std::size_t j = head_ + i;
+        return chunks_[j >> kChunkShift][j & (kChunkSize - 1)];
+    }
+
+    const T& operator[](std::size_t i) const {
+        std::size_t j = head_ + i;
+        return chunks_[j >> kChunkShift][j & (kChunkSize - 1)];
+    }
+
+    T& back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t capacity() const { return chunks_.size() * kChunkSize - head_; }
+};
+
+/********************************************************************************
+ * sliding_array
+ * ------------------------------------------------------------------------------
+ * Contiguous counterpart of chunked_array with the same interface: a
+ * std::vector whose first head_ entries have been popped from the front.
+ * Growing copies the whole array, as std::vector does, but when at least half
+ * of it has been popped the live entries slide down to the start instead.
+ ********************************************************************************/
+template<typename T>
+class sliding_array {
+    static_assert(std::is_trivially_copyable<T>::value, "sliding_array holds trivially copyable entries");
+
+    std::vector<T> data_;
+    // Index of entry 0 in data_.
+    std::size_t head_ = 0;
+
+    void slide() {
+        data_.erase(data_.begin(), data_.begin() + head_);
+        head_ = 0;
+    }
+
+public:
+    sliding_array() = default;
+
+    sliding_array(sliding_array&& other) noexcept
+        : data_(std::move(other.data_)), head_(std::exchange(other.head_, 0)) {}
+
+    sliding_array& operator=(sliding_array&& other) noexcept {
+        data_ = std::move(other.data_);
+        head_ = std::exchange(other.head_, 0);
+        return *this;
+    }
+
+    // Makes room for n entries in all, so that pushing up to that size cannot
+    // throw.
+    void reserve(std::size_t n) {
+        if (head_ + n <= data_.capacity())
+            return;
+        if (head_ >= size())
+            slide();
+        if (head_ + n > data_.capacity())
+            data_.reserve(std::max(head_ + n, 2 * data_.capacity()));
+    }
+
+    void push_back(T value) {
+        if (data_.size() == data_.capacity())
+            reserve(size() + 1);
+        data_.push_back(value);
+    }
+
+    void pop_back() {
+        data_.pop_back();
+        if (data_.size() == head_)
+            clear();
+    }
+
+    void pop_front() {
+        if (++head_ == data_.size())
+            clear();
+    }
+
+    // Drops the entries from index n on; n must not exceed size().
+    void truncate(std::size_t n) {
+        data_.resize(head_ + n);
+        if (n == 0)
+            clear();
+    }
+
+    // Empties the array but keeps its capacity, like std::vector::clear.
+    void clear() noexcept {
+        data_.clear();
+        head_ = 0;
+    }
+
+    void shrink_to_fit() {
+        slide();
+        data_.shrink_to_fit();
+    }
+
+    T& operator[](std::size_t i) { return data_[head_ + i]; }
+    const T& operator[](std::size_t i) const { return data_[head_ + i]; }
+
+    T& back() { return data_.back(); }
+    const T& back() const { return data_.back(); }
+
+    std::size_t size() const { return data_.size() - head_; }
+    bool empty() const { return data_.size() == head_; }
+    std::size_t capacity() const { return data_.capacity() - head_; }
+};
+
+/********************************************************************************
+ * default_cache_hash_code
+ * ------------------------------------------------------------------------------
+ * Decides whether nodes store their full hash when the user does not choose.
+ * Scalar keys (integers, enums, pointers) are cheap to rehash and compare, so
+ * the extra word per node is not worth it; anything else, such as strings,
+ * caches the hash.
+ ********************************************************************************/
+template<typename Key>
+struct default_cache_hash_code : std::bool_constant<!std::is_scalar<Key>::value> {};
+
+/********************************************************************************
+ * node_hash_code
+ * ------------------------------------------------------------------------------
+ * Base class of chained nodes holding the cached hash. The false
+ * specialization is empty and costs nothing thanks to the empty base
+ * optimization.
+ ********************************************************************************/
+template<bool CacheHashCode>
+struct node_hash_code {
+    void store_hash(std::size_t) {}
+};
+
+template<>
+struct node_hash_code<true> {
+    std::size_t hash_code;
+    void store_hash(std::size_t h) { hash_code = h; }
+};
+
+/********************************************************************************
+ * event_counts
+ * ------------------------------------------------------------------------------
+ * Values reported by a container built with event counting enabled (see
+ * unordered_set_traits). Probes are chain nodes visited by lookups; key
+ * comparisons are the KeyEqual calls among them. Rehash times are in
+ * nanoseconds; for an incremental rehash the start and every migration step
+ * are timed separately, so the maximum is the longest single pause.
+ ********************************************************************************/
+struct event_counts {
+    std::uint64_t lookups = 0;
+    std::uint64_t probes = 0;
+    std::uint64_t key_comparisons = 0;
+    std::uint64_t rehashes = 0;
+    std::uint64_t rehash_nanoseconds = 0;
+    std::uint64_t max_rehash_nanoseconds = 0;
+    std::uint64_t node_allocations = 0;
+    std::uint64_t allocator_calls = 0;
+};
+
+/********************************************************************************
+ * event_counters
+ * ------------------------------------------------------------------------------
+ * Base class of unordered_set that records hot-path events. The false
+ * specialization is empty and all its hooks are empty inline functions, so
+ * with counting disabled the container is the same size and the hooks
+ * compile to nothing. The enabled counters are relaxed atomics, because
+ * const lookups update them and may run concurrently; a copied or moved
+ * container starts with its own counters at zero.
+ ********************************************************************************/
+template<bool Enabled>
+class event_counters {
+protected:
+    struct no_timer {};
+
+    void count_lookup() const {}
+    void count_probe() const {}
+    void count_key_comparison() const {}
+    void count_rehash() {}
+    void count_node_allocation(bool) const {}
+    void count_allocator_call() {}
+    no_timer start_timer() const { return {}; }
+    void add_rehash_time(no_timer) {}
+
+public:
+    event_counts counters() const { return {}; }
+    void reset_counters() {}
+};
+
+template<>
+class event_counters<true> {
+    using clock = std::chrono::steady_clock;
+
+    mutable std::atomic<std::uint64_t> lookups{ 0 };
+    mutable std::atomic<std::uint64_t> probes{ 0 };
+    mutable std::atomic<std::uint64_t> key_comparisons{ 0 };
+    mutable std::atomic<std::uint64_t> node_allocations{ 0 };
+    mutable std::atomic<std::uint64_t> allocator_calls{ 0 };
+    std::atomic<std::uint64_t> rehashes{ 0 };
+    std::atomic<std::uint64_t> rehash_nanoseconds{ 0 };
+    std::atomic<std::uint64_t> max_rehash_nanoseconds{ 0 };
+
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t n = 1) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+protected:
+    event_counters() = default;
+    event_counters(const event_counters&) noexcept {}
+    event_counters& operator=(const event_counters&) noexcept { return *this; }
+
+    void count_lookup() const { bump(lookups); }
+    void count_probe() const { bump(probes); }
+    void count_key_comparison() const { bump(key_comparisons); }
+    void count_rehash() { bump(rehashes); }
+
+    // Called from parallel set algebra threads as well, hence atomic.
+    void count_node_allocation(bool new_slab) const {
+        bump(node_allocations);
+        if (new_slab)
+            bump(allocator_calls);
+    }
+
+    void count_allocator_call() { bump(allocator_calls); }
+
+    clock::time_point start_timer() const { return clock::now(); }
+
+    void add_rehash_time(clock::time_point start) {
+        auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+        bump(rehash_nanoseconds, ns);
+        if (ns > max_rehash_nanoseconds.load(std::memory_order_relaxed))
+            max_rehash_nanoseconds.store(ns, std::memory_order_relaxed);
+    }
+
+public:
+    event_counts counters() const {
+        event_counts c;
+        c.lookups = lookups.load(std::memory_order_relaxed);
+        c.probes = probes.load(std::memory_order_relaxed);
+        c.key_comparisons = key_comparisons.load(std::memory_order_relaxed);
+        c.rehashes = rehashes.load(std::memory_order_relaxed);
+        c.rehash_nanoseconds = rehash_nanoseconds.load(std::memory_order_relaxed);
+        c.max_rehash_nanoseconds = max_rehash_nanoseconds.load(std::memory_order_relaxed);
+        c.node_allocations = node_allocations.load(std::memory_order_relaxed);
+        c.allocator_calls = allocator_calls.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    void reset_counters() {
+        for (auto* counter : { &lookups, &probes, &key_comparisons, &node_allocations, &allocator_calls,
+                               &rehashes, &rehash_nanoseconds, &max_rehash_nanoseconds })
+            counter->store(0, std::memory_order_relaxed);
+    }
+};
+
+/********************************************************************************
+ * is_transparent_lookup
+ * ------------------------------------------------------------------------------
+ * True when both the hasher and the key comparator declare is_transparent, so
+ * lookups may take any type they accept (e.g. std::string_view for
+ * std::string keys) without building a temporary key_type.
+ ********************************************************************************/
+template<typename Hash, typename KeyEqual, typename = void>
+struct is_transparent_lookup : std::false_type {};
+
+template<typename Hash, typename KeyEqual>
+struct is_transparent_lookup<Hash, KeyEqual,
+    std::void_t<typename Hash::is_transparent, typename KeyEqual::is_transparent>> : std::true_type {};
+
+} // namespace unordered_set_detail
+
+#endif
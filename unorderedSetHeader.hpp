@@ -4,18 +4,85 @@
 #include <vector>
 #include <functional>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <initializer_list>
 #include <iterator>
+#include <string>
 #include <memory>
+#include <type_traits>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "nodePool.hpp"
+#include "snapshotFormat.hpp"
+#include "unorderedSetDetail.hpp"
+
+template<bool CacheHashCode, bool IncrementalRehash = false, bool CountEvents = false>
+struct unordered_set_traits {
+    static constexpr bool cache_hash_code = CacheHashCode;
+    static constexpr bool incremental_rehash = IncrementalRehash;
+    static constexpr bool count_events = CountEvents;
+};
+
+using unordered_set_counters = unordered_set_detail::event_counts;
+
+// Snapshot of a table's shape, returned by unordered_set::stats().
+struct unordered_set_stats {
+    std::size_t size = 0;
+    std::size_t bucket_count = 0;
+    float load_factor = 0.0f;
+    float max_load_factor = 0.0f;
+    float min_load_factor = 0.0f;
+    std::size_t empty_buckets = 0;
+    double empty_bucket_ratio = 0.0;
+    std::size_t longest_chain = 0;
+    // Mean number of nodes visited by a successful lookup.
+    double average_probe_length = 0.0;
+    // chain_length_histogram[k] is the number of buckets holding k elements.
+    std::vector<std::size_t> chain_length_histogram;
+    std::size_t bucket_bytes = 0;
+    // Capacity of the element array, and how many of its used slots are holes
+    // left by erased elements.
+    std::size_t element_bytes = 0;
+    std::size_t element_holes = 0;
+    // Node slabs held by this set, including slabs shared with sets it
+    // exchanged nodes with, and the part of them its own elements use.
+    std::size_t node_bytes = 0;
+    std::size_t node_bytes_in_use = 0;
+    bool rehash_in_progress = false;
+    // Event counters; all zero unless Traits enables counting.
+    bool counters_enabled = false;
+    unordered_set_counters counters;
+};
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+class unordered_set;
+
+// Bulk set algebra. Each result is sized once up front, and the work can be
+// split across `threads` threads by bucket range. Both operands must hash and
+// compare keys the same way.
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits> set_union(const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& a, const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& b, unsigned threads = 1);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits> set_intersection(const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& a, const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& b, unsigned threads = 1);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits> set_difference(const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& a, const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& b, unsigned threads = 1);
 
 template<
     typename Key,
     typename Hash = std::hash<Key>,
     typename KeyEqual = std::equal_to<Key>,
-    typename Allocator = std::allocator<Key>
+    typename Allocator = std::allocator<Key>,
+    typename Traits = unordered_set_traits<unordered_set_detail::default_cache_hash_code<Key>::value>
 >
-class unordered_set {
+class unordered_set : private unordered_set_detail::event_counters<Traits::count_events> {
+    using counters_base = unordered_set_detail::event_counters<Traits::count_events>;
+
 public:
     using key_type = Key;
     using value_type = Key;
@@ -24,38 +91,123 @@ public:
     using allocator_type = Allocator;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
+    using traits_type = Traits;
 
 private:
-    struct Node {
+    struct Node : unordered_set_detail::node_hash_code<Traits::cache_hash_code> {
         value_type value;
+        // Position in elements plus slot_offset; 32 bits fit next to small
+        // keys without growing the node.
+        std::uint32_t slot;
         Node* next;
-        Node(const value_type& val) : value(val), next(nullptr) {}
-        Node(value_type&& val) : value(std::move(val)), next(nullptr) {}
+        template<typename... Args>
+        explicit Node(std::in_place_t, Args&&... args) : value(std::forward<Args>(args)...), slot(0), next(nullptr) {}
     };
 
-    std::vector<Node*> buckets;
+    using node_pool_type = unordered_set_detail::node_pool<Node, Allocator>;
+
+    unordered_set_detail::bucket_array<Node*> buckets;
     size_type bucket_count_;
     size_type num_elements;
     float max_load_factor_;
-    hasher has_func;
+    float min_load_factor_;
+    hasher hash_func;
     key_equal key_eq;
-    allocator_type alloc;
+    node_pool_type pool;
+
+    // Incremental rehash state: while old_buckets is non-empty, old buckets
+    // below migrated_buckets have been split into buckets; the rest still
+    // hold their nodes.
+    unordered_set_detail::bucket_array<Node*> old_buckets;
+    size_type migrated_buckets;
+
+    // Every linked node in iteration order. Erasing leaves a nullptr hole;
+    // holes at either end are dropped at once, and the rest are squeezed out
+    // once they outnumber the elements, so iteration and clear() cost
+    // O(size()) whatever the bucket count. Node slots count from slot_offset
+    // (mod 2^32), so dropping holes at the front does not renumber the nodes
+    // behind them. While compacting, the entries below compact_read have
+    // been moved down to below compact_write. With Traits::incremental_rehash
+    // the array is chunked, so that no insert copies it whole; otherwise it
+    // is contiguous, which iterates faster.
+    using element_array = std::conditional_t<Traits::incremental_rehash,
+                                             unordered_set_detail::chunked_array<Node*>,
+                                             unordered_set_detail::sliding_array<Node*>>;
+    element_array elements;
+    std::uint32_t slot_offset;
+    bool compacting;
+    size_type compact_read;
+    size_type compact_write;
 
-    Node* create_node(const value_type& value);
-    Node* create_node(value_type&& value);
+    Node* allocate_node(node_pool_type& nodes) const;
+    template<typename... Args>
+    Node* create_node(Args&&... args);
     void destroy_node(Node* node);
 
+    template<typename K>
+    size_type hash_of(const K& key) const;
+    size_type node_hash(const Node* node) const;
+    size_type transferred_hash(const Node* node) const;
+    template<typename K>
+    bool node_matches(const Node* node, const K& key, size_type hash) const;
+    size_type bucket_index(size_type hash) const;
+    Node* const* chain_slot(size_type hash) const;
+    Node** chain_slot(size_type hash);
+    Node* bucket_begin(size_type index) const;
+    Node* bucket_next(const Node* node, size_type index) const;
+
+    static constexpr size_type kMaxElementSlots = UINT32_MAX;
+    static constexpr size_type kMinElementHoles = 16;
+    static constexpr size_type kMinShrinkBuckets = 16;
+    // clear() resets buckets one by one rather than all at once when there
+    // are at least this many buckets per element.
+    static constexpr size_type kSparseClearRatio = 16;
+
+    void reserve_elements(size_type extra);
+    void push_element(Node* node);
+    void drop_element(Node* node);
+    void compact_elements();
+    void compact_step(size_type budget);
+    size_type position_of(const Node* node) const;
+    Node* first_element() const;
+    Node* element_after(const Node* node) const;
+
+    static constexpr size_type kPrefetchDistance = 16;
+
+    // Move assignment can only fail when it has to move the elements one by
+    // one into nodes from this container's allocator, as std::unordered_set.
+    static constexpr bool kNothrowMoveAssign =
+        (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+         std::allocator_traits<Allocator>::is_always_equal::value) &&
+        std::is_nothrow_move_assignable<Hash>::value && std::is_nothrow_move_assignable<KeyEqual>::value;
+
+    template<typename K>
+    Node* locate(const K& key, size_type hash) const;
+    template<typename K>
+    size_type erase_key(const K& key, size_type hash);
+
+    static constexpr size_type kRehashStep = 4;
+    // Element array entries a pending compaction moves per insert or erase
+    // with Traits::incremental_rehash.
+    static constexpr size_type kCompactStep = 16;
+
+    bool migrating() const;
+    void migrate_bucket(size_type old_index);
+    void migrate_step();
+    void finish_migration();
+
     void rehash_if_needed();
+    void shrink_if_needed();
 public:
     class iterator {
     public:
         using iterator_category = std::forward_iterator_tag;
         using value_type = unordered_set::value_type;
-        using difference_type = unordered_set:difference_type;
+        using difference_type = unordered_set::difference_type;
         using pointer = value_type*;
         using reference = value_type&;
 
-        iterator() : container(nullptr), bucket_index(0), current(nullptr) {}
+        iterator() : container(nullptr), current(nullptr) {}
 
         reference operator*() const {
             return current->value;
@@ -74,22 +226,22 @@ public:
     private:    
         friend class unordered_set;
         unordered_set* container;
-        size_type bucket_index;
         Node* current;
 
-        iterator(unordered_set* cont, size_type index, Node* node)
-            : container(cont), bucket_index(index), current(node) {}
+        iterator(unordered_set* cont, Node* node) : container(cont), current(node) {}
     };
 
     class const_iterator {
     public:
         using iterator_category = std::forward_iterator_tag;
         using value_type = unordered_set::value_type;
-        using difference_type = unordered_set:difference_type;
+        using difference_type = unordered_set::difference_type;
         using pointer = const value_type*;
         using reference = const value_type&;
 
-        iterator() : container(nullptr), bucket_index(0), current(nullptr) {}
+        const_iterator() : container(nullptr), current(nullptr) {}
+
+        const_iterator(const iterator& it) : container(it.container), current(it.current) {}
 
         reference operator*() const {
             return current->value;
@@ -108,11 +260,107 @@ public:
     private:    
         friend class unordered_set;
         const unordered_set* container;
-        size_type bucket_index;
         const Node* current;
 
-        const_iterator(const unordered_set* cont, size_type index, const Node* node)
-            : container(cont), bucket_index(index), current(node) {}
+        const_iterator(const unordered_set* cont, const Node* node) : container(cont), current(node) {}
+    };
+
+private:
+    template<typename K>
+    using enable_if_transparent_t = std::enable_if_t<
+        unordered_set_detail::is_transparent_lookup<Hash, KeyEqual>::value &&
+        !std::is_convertible<const K&, iterator>::value &&
+        !std::is_convertible<const K&, const_iterator>::value, int>;
+
+    template<typename K>
+    using enable_if_key_or_transparent_t = std::enable_if_t<
+        std::is_same<std::decay_t<K>, key_type>::value ||
+        unordered_set_detail::is_transparent_lookup<Hash, KeyEqual>::value, int>;
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> emplace_unique(const K& key, size_type hash, Args&&... args);
+    iterator link_node(Node* node, size_type hash);
+    Node* unlink_node(const_iterator pos);
+    void clone_from(const unordered_set& other);
+    template<typename Keep>
+    void copy_matching(const unordered_set& source, Keep keep, unsigned threads);
+
+    template<typename K, typename H, typename E, typename A, typename T>
+    friend unordered_set<K, H, E, A, T> set_union(const unordered_set<K, H, E, A, T>&, const unordered_set<K, H, E, A, T>&, unsigned);
+    template<typename K, typename H, typename E, typename A, typename T>
+    friend unordered_set<K, H, E, A, T> set_intersection(const unordered_set<K, H, E, A, T>&, const unordered_set<K, H, E, A, T>&, unsigned);
+    template<typename K, typename H, typename E, typename A, typename T>
+    friend unordered_set<K, H, E, A, T> set_difference(const unordered_set<K, H, E, A, T>&, const unordered_set<K, H, E, A, T>&, unsigned);
+
+public:
+    // Owns an element extracted from the set, without copying it. The value
+    // may be modified and the node inserted into this or another set with an
+    // equal allocator. Destroying a non-empty handle destroys the value; its
+    // storage returns to the allocator with the rest of its slab.
+    class node_type {
+    public:
+        using value_type = unordered_set::value_type;
+        using allocator_type = unordered_set::allocator_type;
+
+        node_type() noexcept : node(nullptr) {}
+
+        node_type(node_type&& other) noexcept
+            : node(std::exchange(other.node, nullptr)), slabs(std::move(other.slabs)) {}
+
+        node_type& operator=(node_type&& other) noexcept {
+            if (this != &other) {
+                reset();
+                node = std::exchange(other.node, nullptr);
+                slabs = std::move(other.slabs);
+            }
+            return *this;
+        }
+
+        ~node_type() {
+            reset();
+        }
+
+        bool empty() const noexcept {
+            return node == nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return node != nullptr;
+        }
+
+        value_type& value() const {
+            return node->value;
+        }
+
+        allocator_type get_allocator() const {
+            return node_pool_type::allocator_of(slabs);
+        }
+
+        void swap(node_type& other) noexcept {
+            std::swap(node, other.node);
+            slabs.swap(other.slabs);
+        }
+
+    private:
+        friend class unordered_set;
+        Node* node;
+        typename node_pool_type::slab_ref slabs;
+
+        node_type(Node* n, typename node_pool_type::slab_ref s) : node(n), slabs(std::move(s)) {}
+
+        void reset() noexcept {
+            if (node) {
+                node->~Node();
+                node = nullptr;
+            }
+            slabs.reset();
+        }
+    };
+
+    struct insert_return_type {
+        iterator position;
+        bool inserted;
+        node_type node;
     };
 
     unordered_set();
@@ -121,9 +369,11 @@ public:
     unordered_set(const unordered_set& other);
     unordered_set(unordered_set&& other) noexcept;
     unordered_set& operator=(const unordered_set& other);
-    unordered_set& operator=(unordered_set&& other) noexcept;
+    unordered_set& operator=(unordered_set&& other) noexcept(kNothrowMoveAssign);
     ~unordered_set();
 
+    allocator_type get_allocator() const;
+
     iterator begin();
     iterator end();
     const_iterator begin() const;
@@ -136,23 +386,66 @@ public:
     float load_factor() const;
     float max_load_factor() const;
     void max_load_factor(float ml);
+    float min_load_factor() const;
+    void min_load_factor(float ml);
 
     void clear();
     std::pair<iterator, bool> insert(const value_type& value);
     std::pair<iterator, bool> insert(value_type&& value);
 
+    iterator insert(const_iterator hint, const value_type& value);
+    iterator insert(const_iterator hint, value_type&& value);
+
     template<typename... Args>
     std::pair<iterator, bool> emplace(Args&&... args);
+    template<typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
+    template<typename K, typename... Args, typename = enable_if_key_or_transparent_t<K>>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
 
     iterator erase(const_iterator pos);
+    iterator erase(iterator pos);
     size_type erase(const key_type& key);
+    template<typename K, typename = enable_if_transparent_t<K>>
+    size_type erase(const K& key);
 
     iterator find(const key_type& key);
     const_iterator find(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    iterator find(const K& key);
+    template<typename K, typename = enable_if_transparent_t<K>>
+    const_iterator find(const K& key) const;
     size_type count(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    size_type count(const K& key) const;
+    bool contains(const key_type& key) const;
+    template<typename K, typename = enable_if_transparent_t<K>>
+    bool contains(const K& key) const;
+
+    template<typename K, typename = enable_if_key_or_transparent_t<K>>
+    size_type find_many(const K* keys, size_type n, std::uint64_t* out_bitmap) const;
+    template<typename InputIt>
+    void insert_range(InputIt first, InputIt last);
+    template<typename K, typename = enable_if_key_or_transparent_t<K>>
+    size_type erase_many(const K* keys, size_type n);
+
+    node_type extract(const_iterator pos);
+    node_type extract(const key_type& key);
+    insert_return_type insert(node_type&& nh);
+    iterator insert(const_iterator hint, node_type&& nh);
+    void merge(unordered_set& source);
+    void merge(unordered_set&& source);
+
+    void save(const std::string& path) const;
+    void load(const std::string& path);
 
     void rehash(size_type new_bucket_count);
     void reserve(size_type count);
+    void shrink_to_fit();
+
+    unordered_set_stats stats() const;
+    using counters_base::counters;
+    using counters_base::reset_counters;
 };
 
 #include "unorderedSetImplementation.tpp"
@@ -1,43 +1,64 @@
 #include "unorderedSetHeader.hpp"
 
 /********************************************************************************
- * create_node (const value_type&)
+ * allocate_node
  * ------------------------------------------------------------------------------
- * Creates a new node by copying the provided value.
+ * Takes raw storage for one node from a pool. With event counting enabled it
+ * also records the allocation, and whether the pool had to ask the allocator
+ * for a new slab.
  *
  * Parameters:
- *   - value: The value to be stored in the node.
+ *   - nodes: The pool to allocate from.
  *
  * Returns:
- *   - Pointer to the newly created Node.
+ *   - Uninitialized storage for a Node.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::Node*
-unordered_set<Key, Hash, KeyEqual, Allocator>::create_node(const value_type& value) {
-    return new Node(value);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::allocate_node(node_pool_type& nodes) const {
+    if constexpr (Traits::count_events) {
+        std::size_t slab_bytes = nodes.requested_bytes();
+        Node* node = nodes.allocate();
+        this->count_node_allocation(nodes.requested_bytes() != slab_bytes);
+        return node;
+    }
+    else {
+        return nodes.allocate();
+    }
 }
 
 /********************************************************************************
- * create_node (value_type&&)
+ * create_node
  * ------------------------------------------------------------------------------
- * Creates a new node by moving the provided value.
+ * Creates a new node whose value is constructed in place from args. Storage
+ * comes from the node pool, which reuses freed nodes before asking the
+ * allocator for a slab. The caller stores the hash and links the node.
  *
  * Parameters:
- *   - value: The rvalue reference to the value that will be moved into the node.
+ *   - args: Arguments forwarded to the value_type constructor.
  *
  * Returns:
  *   - Pointer to the newly created Node.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::Node*
-unordered_set<Key, Hash, KeyEqual, Allocator>::create_node(value_type&& value) {
-    return new Node(std::move(value));
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename... Args>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::create_node(Args&&... args) {
+    Node* node = allocate_node(pool);
+    try {
+        ::new (static_cast<void*>(node)) Node(std::in_place, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        pool.deallocate(node);
+        throw;
+    }
+    return node;
 }
 
 /********************************************************************************
  * destroy_node
  * ------------------------------------------------------------------------------
- * Destroys the given node, deallocating its memory.
+ * Destroys the given node and returns its storage to the node pool's free list.
  *
  * Parameters:
  *   - node: Pointer to the node to destroy.
@@ -45,775 +66,2170 @@ unordered_set<Key, Hash, KeyEqual, Allocator>::create_node(value_type&& value) {
  * Returns:
  *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-void unordered_set<Key, Hash, KeyEqual, Allocator>::destroy_node(Node* node) {
-    delete node;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::destroy_node(Node* node) {
+    node->~Node();
+    pool.deallocate(node);
 }
 
 /********************************************************************************
- * rehash_if_needed
+ * hash_of
  * ------------------------------------------------------------------------------
- * Checks if the current load factor exceeds the maximum load factor.
- * If it does, rehashes the container by doubling the number of buckets.
+ * Hashes a key with the user's hasher and post-mixes the result, so that weak
+ * hashes (such as the identity std::hash<int>) still spread over the low bits
+ * selected by the bucket mask.
  *
  * Parameters:
- *   - None.
+ *   - key: The key to hash; any type the hasher accepts.
  *
  * Returns:
- *   - None.
+ *   - The mixed hash value.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-void unordered_set<Key, Hash, KeyEqual, Allocator>::rehash_if_needed() {
-    if (load_factor() > max_load_factor_) {
-        rehash(bucket_count_ * 2);
-    }
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::hash_of(const K& key) const {
+    return unordered_set_detail::mix_hash(hash_func(key));
 }
 
 /********************************************************************************
- * Default Constructor
+ * node_hash
  * ------------------------------------------------------------------------------
- * Constructs an unordered_set with default values.
- * Sets an initial bucket count of 16 and a max load factor of 1.0.
+ * Retrieves the mixed hash of a node's value, from the node itself when hash
+ * codes are cached and by calling the hasher otherwise.
+ *
+ * Parameters:
+ *   - node: The node whose hash is needed.
+ *
+ * Returns:
+ *   - The mixed hash value.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>::unordered_set() 
-    : bucket_count_(16), num_elements(0), max_load_factor_(1.0),
-      hash_func(Hash()), key_eq(KeyEqual()), alloc(Allocator())
-{
-    buckets.resize(bucket_count_, nullptr);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::node_hash(const Node* node) const {
+    if constexpr (Traits::cache_hash_code)
+        return node->hash_code;
+    else
+        return hash_of(node->value);
 }
 
 /********************************************************************************
- * Constructor with bucket_count_
+ * transferred_hash
  * ------------------------------------------------------------------------------
- * Constructs an unordered_set with a user-defined bucket count, hash functor,
- * key equality function, and allocator.
+ * Hash of a node that is being moved or copied in from another container with
+ * an equivalent hasher. A cached hash code is reused when the hasher has no
+ * state, since two instances must then agree; otherwise the hash is computed
+ * with this container's hasher.
  *
  * Parameters:
- *   - bucket_count_: Initial number of buckets.
- *   - hash_func_: Hash function for keys.
- *   - equal: Equality function for keys.
- *   - alloc_: Allocator to use.
+ *   - node: The node coming from the other container.
+ *
+ * Returns:
+ *   - The mixed hash value under this container's hasher.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>::unordered_set(size_type bucket_count_, 
-                                                              const hasher& hash_func_, 
-                                                              const key_equal& equal, 
-                                                              const allocator_type& alloc_) 
-    : bucket_count_(bucket_count_ > 0 ? bucket_count_ : 16), num_elements(0), max_load_factor_(1.0),
-      hash_func(hash_func_), key_eq(equal), alloc(alloc_)
-{
-    buckets.resize(bucket_count_, nullptr);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::transferred_hash(const Node* node) const {
+    if constexpr (Traits::cache_hash_code && std::is_empty<Hash>::value)
+        return node->hash_code;
+    else
+        return hash_of(node->value);
 }
 
 /********************************************************************************
- * Initializer List Constructor
+ * node_matches
  * ------------------------------------------------------------------------------
- * Constructs an unordered_set using an initializer_list, with an optional initial
- * bucket count, hash functor, key equality function, and allocator.
+ * Tests whether a node holds key. With cached hash codes the stored hash is
+ * compared first, so key_eq only runs on a probable match. Every call is one
+ * probe for the event counters.
  *
  * Parameters:
- *   - init: Initializer list of values.
- *   - bucket_count_: Initial bucket count (optional).
- *   - hash_func_: Hash function.
- *   - equal: Equality function.
- *   - alloc_: Allocator.
+ *   - node: The node to test.
+ *   - key: The key being looked up.
+ *   - hash: The mixed hash of key.
+ *
+ * Returns:
+ *   - true if the node's value equals key.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>::unordered_set(
-    std::initializer_list<value_type> init,
-    size_type bucket_count_,
-    const hasher& hash_func_,
-    const key_equal& equal,
-    const allocator_type& alloc_)
-    : unordered_set(bucket_count_ ? bucket_count_ : init.size(), hash_func_, equal, alloc_)
-{
-    for (const auto& val : init) {
-        insert(val);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::node_matches(const Node* node, const K& key, size_type hash) const {
+    this->count_probe();
+    if constexpr (Traits::cache_hash_code) {
+        if (node->hash_code != hash)
+            return false;
     }
+    this->count_key_comparison();
+    return key_eq(node->value, key);
 }
 
 /********************************************************************************
- * Copy Constructor
+ * bucket_index
  * ------------------------------------------------------------------------------
- * Constructs a new unordered_set as a copy of an existing one.
+ * Maps a mixed hash to a bucket. Bucket counts are always powers of two, so
+ * this is a mask rather than a division.
  *
  * Parameters:
- *   - other: The unordered_set to copy.
+ *   - hash: The mixed hash value.
+ *
+ * Returns:
+ *   - Index of the bucket in [0, bucket_count_).
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>::unordered_set(const unordered_set& other)
-    : bucket_count_(other.bucket_count_), num_elements(0),
-      max_load_factor_(other.max_load_factor_), hash_func(other.hash_func),
-      key_eq(other.key_eq), alloc(other.alloc)
-{
-    buckets.resize(bucket_count_, nullptr);
-    for (const auto& val : other) {
-        insert(val);
-    }
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::bucket_index(size_type hash) const {
+    return hash & (bucket_count_ - 1);
 }
 
 /********************************************************************************
- * Move Constructor
+ * chain_slot
  * ------------------------------------------------------------------------------
- * Constructs a new unordered_set by moving an existing one.
+ * Finds the bucket slot heading the chain a hash belongs to. While an
+ * incremental rehash is in progress that is the old bucket if it has not been
+ * migrated yet and the new bucket otherwise; since buckets migrate in index
+ * order, exactly one table can hold the key and only that one is searched.
  *
  * Parameters:
- *   - other: The unordered_set to move from.
+ *   - hash: The mixed hash value.
+ *
+ * Returns:
+ *   - Pointer to the slot holding the chain's first node.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>::unordered_set(unordered_set&& other) noexcept
-    : buckets(std::move(other.buckets)), bucket_count_(other.bucket_count_),
-      num_elements(other.num_elements), max_load_factor_(other.max_load_factor_),
-      hash_func(std::move(other.hash_func)), key_eq(std::move(other.key_eq)), alloc(std::move(other.alloc))
-{
-    other.bucket_count_ = 0;
-    other.num_elements = 0;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node* const*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::chain_slot(size_type hash) const {
+    if constexpr (Traits::incremental_rehash) {
+        if (migrating()) {
+            size_type old_index = hash & (old_buckets.size() - 1);
+            if (old_index >= migrated_buckets)
+                return &old_buckets[old_index];
+        }
+    }
+    return &buckets[bucket_index(hash)];
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node**
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::chain_slot(size_type hash) {
+    return const_cast<Node**>(static_cast<const unordered_set*>(this)->chain_slot(hash));
 }
 
 /********************************************************************************
- * Copy Assignment Operator
+ * bucket_begin / bucket_next
  * ------------------------------------------------------------------------------
- * Assigns the contents of one unordered_set to another using copying.
+ * Enumerate the nodes of one bucket, for the walks that need bucket order
+ * (save, stats and parallel copies). While an incremental rehash is in
+ * progress, a bucket whose old bucket has not been migrated yet is read from
+ * that old chain, skipping the nodes bound for its sibling bucket.
  *
  * Parameters:
- *   - other: The unordered_set to copy from.
+ *   - index: Bucket index in [0, bucket_count_).
+ *   - node: The node the iterator currently points to.
  *
  * Returns:
- *   - Reference to this unordered_set.
+ *   - The first (or next) node of the bucket, or nullptr at its end.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>&
-unordered_set<Key, Hash, KeyEqual, Allocator>::operator=(const unordered_set& other) {
-    if (this != &other) {
-        clear();
-        bucket_count_ = other.bucket_count_;
-        max_load_factor_ = other.max_load_factor_;
-        hash_func = other.hash_func;
-        key_eq = other.key_eq;
-        alloc = other.alloc;
-        buckets.clear();
-        buckets.resize(bucket_count_, nullptr);
-        for (const auto& val : other)
-            insert(val);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::bucket_begin(size_type index) const {
+    if constexpr (Traits::incremental_rehash) {
+        if (migrating() && (index & (old_buckets.size() - 1)) >= migrated_buckets) {
+            Node* current = old_buckets[index & (old_buckets.size() - 1)];
+            while (current && bucket_index(node_hash(current)) != index)
+                current = current->next;
+            return current;
+        }
     }
-    return *this;
+    return buckets[index];
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::bucket_next(const Node* node, size_type index) const {
+    Node* current = node->next;
+    if constexpr (Traits::incremental_rehash) {
+        if (migrating() && (index & (old_buckets.size() - 1)) >= migrated_buckets) {
+            while (current && bucket_index(node_hash(current)) != index)
+                current = current->next;
+        }
+    }
+    return current;
 }
 
 /********************************************************************************
- * Move Assignment Operator
+ * locate
  * ------------------------------------------------------------------------------
- * Assigns the contents of one unordered_set to another using move semantics.
+ * Walks the bucket chain selected by hash looking for key.
  *
  * Parameters:
- *   - other: The unordered_set to move from.
+ *   - key: The key to look for; key_type or a transparent lookup type.
+ *   - hash: The mixed hash of key.
  *
  * Returns:
- *   - Reference to this unordered_set.
+ *   - The matching node, or nullptr if absent.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>&
-unordered_set<Key, Hash, KeyEqual, Allocator>::operator=(unordered_set&& other) noexcept {
-    if (this != &other) {
-        clear();
-        buckets = std::move(other.buckets);
-        bucket_count_ = other.bucket_count_;
-        num_elements = other.num_elements;
-        max_load_factor_ = other.max_load_factor_;
-        hash_func = std::move(other.hash_func);
-        key_eq = std::move(other.key_eq);
-        alloc = std::move(other.alloc);
-        other.bucket_count_ = 0;
-        other.num_elements = 0;
-    }
-    return *this;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::locate(const K& key, size_type hash) const {
+    this->count_lookup();
+    Node* current = *chain_slot(hash);
+    while (current && !node_matches(current, key, hash))
+        current = current->next;
+    return current;
 }
 
 /********************************************************************************
- * Destructor
+ * link_node
  * ------------------------------------------------------------------------------
- * Destroys the unordered_set and releases all allocated resources.
+ * Stores the hash in a freshly created node, pushes it onto the front of its
+ * bucket chain and appends it to the element array. The caller has made room
+ * in the array first (rehash_if_needed or reserve_elements), so this does not
+ * throw.
+ *
+ * Parameters:
+ *   - node: The node to link.
+ *   - hash: The mixed hash of the node's value.
+ *
+ * Returns:
+ *   - Iterator to the linked node.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-unordered_set<Key, Hash, KeyEqual, Allocator>::~unordered_set() {
-    clear();
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::link_node(Node* node, size_type hash) {
+    node->store_hash(hash);
+    Node** slot = chain_slot(hash);
+    node->next = *slot;
+    *slot = node;
+    push_element(node);
+    ++num_elements;
+    return iterator(this, node);
 }
 
 /********************************************************************************
- * iterator::operator++ (Prefix)
+ * unlink_node
  * ------------------------------------------------------------------------------
- * Advances the iterator to the next element in the container.
+ * Removes the node at pos from its chain and from the element array without
+ * destroying it. Shared by erase and extract.
+ *
+ * Parameters:
+ *   - pos: Position of the node; must belong to this container.
  *
  * Returns:
- *   - Reference to the updated iterator.
+ *   - The unlinked node, or nullptr if pos does not refer to a node here.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator&
-unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator++() {
-    if (current && current->next) {
-        current = current->next;
-    }
-    else {
-        ++bucket_index;
-        while (bucket_index < container->bucket_count_ && container->buckets[bucket_index] == nullptr) {
-            ++bucket_index;
-        }
-        current = (bucket_index < container->bucket_count_) ? container->buckets[bucket_index] : nullptr;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::unlink_node(const_iterator pos) {
+    Node** link = chain_slot(node_hash(pos.current));
+    while (*link && *link != pos.current)
+        link = &(*link)->next;
+    Node* node = *link;
+    if (node) {
+        *link = node->next;
+        drop_element(node);
+        --num_elements;
     }
-    return *this;
+    return node;
 }
 
 /********************************************************************************
- * iterator::operator++ (Postfix)
+ * reserve_elements
  * ------------------------------------------------------------------------------
- * Advances the iterator to the next element, returning the original value.
+ * Makes room in the element array for extra more nodes, so that the pushes
+ * that follow cannot throw. With Traits::incremental_rehash the array grows a
+ * chunk at a time and never copies its entries, so making room for one node
+ * costs at most one chunk allocation; otherwise it grows geometrically, like
+ * a vector. Slots are 32-bit; holes are squeezed out before giving up on that
+ * limit.
+ *
+ * Parameters:
+ *   - extra: Number of nodes about to be linked.
  *
  * Returns:
- *   - Iterator pointing to the element before the increment.
+ *   - None. Throws std::length_error past 2^32 - 1 elements.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator++(int) {
-    iterator tmp = *this;
-    ++(*this);
-    return tmp;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::reserve_elements(size_type extra) {
+    if (elements.size() + extra > kMaxElementSlots) {
+        compact_elements();
+        if (elements.size() + extra > kMaxElementSlots)
+            throw std::length_error("unordered_set cannot hold more than 2^32 - 1 elements");
+    }
+    elements.reserve(elements.size() + extra);
 }
 
 /********************************************************************************
- * iterator::operator== and operator!=
+ * push_element / drop_element
  * ------------------------------------------------------------------------------
- * Compares two iterators for equality and inequality.
+ * Append a node to the element array, or leave a hole where it was. Holes at
+ * either end are dropped right away, so the first and last entries are always
+ * live and erasing the oldest or the newest elements leaves no holes at all.
+ * Dropping holes at the front shifts the indices of the other entries, which
+ * advancing slot_offset (and the compaction cursors) accounts for; no node is
+ * written. compact_elements is called separately, once the holes pile up.
+ *
+ * Parameters:
+ *   - node: The node being linked or unlinked.
  *
  * Returns:
- *   - true if both iterators point to the same container location, false otherwise.
+ *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-bool unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator==(const iterator &other) const {
-    return container == other.container && bucket_index == other.bucket_index && current == other.current;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::push_element(Node* node) {
+    node->slot = static_cast<std::uint32_t>(elements.size() + slot_offset);
+    elements.push_back(node);
 }
 
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-bool unordered_set<Key, Hash, KeyEqual, Allocator>::iterator::operator!=(const iterator &other) const {
-    return !(*this == other);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::drop_element(Node* node) {
+    size_type pos = position_of(node);
+    elements[pos] = nullptr;
+    if (pos + 1 == elements.size()) {
+        while (!elements.empty() && !elements.back())
+            elements.pop_back();
+        // Everything from compact_read on was holes, and so was the gap below it.
+        if (compacting && compact_read >= elements.size())
+            compacting = false;
+    }
+    else if (pos == 0) {
+        // The last entry is live, so this stops inside the array.
+        size_type dropped = 0;
+        for (; !elements[0]; ++dropped)
+            elements.pop_front();
+        slot_offset = static_cast<std::uint32_t>(slot_offset + dropped);
+        compact_read -= std::min(dropped, compact_read);
+        compact_write -= std::min(dropped, compact_write);
+    }
 }
 
 /********************************************************************************
- * const_iterator::operator++ (Prefix)
+ * compact_elements / compact_step
  * ------------------------------------------------------------------------------
- * Advances the const_iterator to the next element in the container.
+ * Squeeze the holes out of the element array, keeping the order of the live
+ * nodes. A compaction walks the array once with two cursors: each live entry
+ * at compact_read moves down to compact_write, leaving a hole behind, and has
+ * its slot rewritten; the run of nodes before the first hole stays where it
+ * is. Iteration order is the same at every point, so a compaction can be
+ * spread over many operations: compact_step moves on by budget entries, and
+ * entries pushed meanwhile are reached in turn. compact_elements runs a
+ * compaction to the end. Started once the holes outnumber the elements, so
+ * its cost is paid for by the erases that made them.
+ *
+ * Parameters:
+ *   - budget: Number of entries compact_step may move past.
  *
  * Returns:
- *   - Reference to the updated const_iterator.
+ *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator&
-unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator++() {
-    if (current && current->next) {
-        current = current->next;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::compact_elements() {
+    if (!compacting) {
+        compacting = true;
+        compact_read = 0;
+        compact_write = 0;
     }
-    else {
-        ++bucket_index;
-        while (bucket_index < container->bucket_count_ && container->buckets[bucket_index] == nullptr) {
-            ++bucket_index;
+    compact_step(elements.size());
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::compact_step(size_type budget) {
+    size_type stop = compact_read + std::min(budget, elements.size() - compact_read);
+    for (; compact_read < stop; ++compact_read) {
+        size_type ahead = compact_read + kPrefetchDistance;
+        if (compact_write != compact_read && ahead < elements.size() && elements[ahead])
+            unordered_set_detail::prefetch(elements[ahead]);
+        if (Node* node = elements[compact_read]) {
+            if (compact_write != compact_read) {
+                node->slot = static_cast<std::uint32_t>(compact_write + slot_offset);
+                elements[compact_write] = node;
+                elements[compact_read] = nullptr;
+            }
+            ++compact_write;
         }
-        current = (bucket_index < container->bucket_count_) ? container->buckets[bucket_index] : nullptr;
     }
-    return *this;
+    if (compact_read == elements.size()) {
+        elements.truncate(compact_write);
+        // Entries erased after they moved down may now be at the end.
+        while (!elements.empty() && !elements.back())
+            elements.pop_back();
+        compacting = false;
+    }
 }
 
 /********************************************************************************
- * const_iterator::operator++ (Postfix)
+ * position_of
  * ------------------------------------------------------------------------------
- * Advances the const_iterator to the next element, returning its previous state.
+ * Index of a linked node in the element array.
+ *
+ * Parameters:
+ *   - node: A node linked in this container.
  *
  * Returns:
- *   - Const iterator pointing to the element before the increment.
+ *   - Its index in elements.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator++(int) {
-    const_iterator tmp = *this;
-    ++(*this);
-    return tmp;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::position_of(const Node* node) const {
+    return static_cast<std::uint32_t>(node->slot - slot_offset);
 }
 
 /********************************************************************************
- * const_iterator::operator== and operator!=
+ * first_element
  * ------------------------------------------------------------------------------
- * Compares two const_iterators for equality and inequality.
+ * The first node in iteration order. Holes at the front are dropped as soon as
+ * they appear, so this is the first entry of the element array.
  *
  * Returns:
- *   - true if both const_iterators point to the same container location, false otherwise.
+ *   - The first node, or nullptr if the container is empty.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-bool unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator==(const const_iterator &other) const {
-    return container == other.container && bucket_index == other.bucket_index && current == other.current;
-}
-
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-bool unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator::operator!=(const const_iterator &other) const {
-    return !(*this == other);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::first_element() const {
+    return elements.empty() ? nullptr : elements[0];
 }
 
 /********************************************************************************
- * begin() - iterator version
+ * element_after
  * ------------------------------------------------------------------------------
- * Returns an iterator to the first element in the unordered_set.
+ * Finds the node that follows node in iteration order, skipping holes.
+ *
+ * Parameters:
+ *   - node: A node linked in this container.
  *
  * Returns:
- *   - Iterator to the first element, or end() if the container is empty.
+ *   - The next node, or nullptr if node is the last one.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::begin() {
-    for (size_type i = 0; i < bucket_count_; ++i) {
-        if (buckets[i]) {
-            return iterator(this, i, buckets[i]);
-        }
-    }
-    return end();
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::Node*
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::element_after(const Node* node) const {
+    for (size_type i = position_of(node) + 1; i < elements.size(); ++i)
+        if (elements[i])
+            return elements[i];
+    return nullptr;
 }
 
 /********************************************************************************
- * end() - iterator version
+ * clone_from
  * ------------------------------------------------------------------------------
- * Returns an iterator representing the end of the unordered_set.
+ * Copies every element of other into this container, which must be empty,
+ * not migrating, and have at least as many buckets. Elements are known to be
+ * distinct, so each copy is linked straight into its bucket: no lookup, no
+ * load factor check, and no hashing when hash codes can be reused. other is
+ * walked through its element array, so the copy iterates in the same order
+ * and a sparse table costs no more to copy than a dense one. If a copy
+ * throws, the elements copied so far are destroyed.
  *
- * Returns:
- *   - Iterator representing the past-the-end element.
+ * Parameters:
+ *   - other: The container to copy from.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::end() {
-    return iterator(this, bucket_count_, nullptr);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::clone_from(const unordered_set& other) {
+    try {
+        reserve_elements(other.num_elements);
+        for (size_type i = 0; i < other.elements.size(); ++i)
+            if (const Node* node = other.elements[i])
+                link_node(create_node(node->value), transferred_hash(node));
+    }
+    catch (...) {
+        clear();
+        throw;
+    }
 }
 
 /********************************************************************************
- * begin() - const_iterator version
+ * copy_matching
  * ------------------------------------------------------------------------------
- * Returns a const_iterator to the first element in the unordered_set.
+ * Bulk path of the set algebra functions: copies the elements of source for
+ * which keep(value, hash) is true. This container must not be migrating and
+ * must have at least as many buckets as source; both counts are powers of
+ * two, so each source bucket maps onto its own set of result buckets and
+ * disjoint source bucket ranges write disjoint result buckets.
  *
- * Returns:
- *   - Const iterator to the first element, or end() if the container is empty.
+ * A single thread walks source's element array, so the result keeps source's
+ * order. With more than one thread, the source buckets are split into equal
+ * ranges, one per thread. Each thread allocates from its own node pool and
+ * lists its copies locally, so there is no shared state besides the bucket
+ * array; the pools are joined into this container's pool and the lists
+ * appended to the element array afterwards. The first exception thrown by any
+ * thread is rethrown once all have finished, with every copied node already
+ * linked.
+ *
+ * Parameters:
+ *   - source: The container to copy from. keep may read other containers.
+ *   - keep: Predicate called with each value and its hash.
+ *   - threads: Number of threads to use, including the calling one.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::begin() const {
-    for (size_type i = 0; i < bucket_count_; ++i) {
-        if (buckets[i]) {
-            return const_iterator(this, i, buckets[i]);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename Keep>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::copy_matching(const unordered_set& source, Keep keep, unsigned threads) {
+    size_type chunks = std::min<size_type>(std::max(threads, 1u), source.bucket_count_);
+    if (chunks == 0)
+        return;
+
+    // Copies one node if keep accepts it and links it into its bucket; the
+    // caller records it in the element array.
+    auto copy_node = [&](const Node* node, node_pool_type& nodes, auto&& record) {
+        size_type hash = source.node_hash(node);
+        if (!keep(node->value, hash))
+            return;
+        Node* copy = allocate_node(nodes);
+        try {
+            ::new (static_cast<void*>(copy)) Node(std::in_place, node->value);
+        }
+        catch (...) {
+            nodes.deallocate(copy);
+            throw;
+        }
+        try {
+            record(copy);
+        }
+        catch (...) {
+            copy->~Node();
+            nodes.deallocate(copy);
+            throw;
+        }
+        copy->store_hash(hash);
+        Node*& head = buckets[bucket_index(hash)];
+        copy->next = head;
+        head = copy;
+    };
+
+    reserve_elements(source.num_elements);
+    if (chunks == 1) {
+        for (size_type i = 0; i < source.elements.size(); ++i) {
+            if (const Node* node = source.elements[i]) {
+                copy_node(node, pool, [this](Node* copy) {
+                    push_element(copy);
+                    ++num_elements;
+                });
+            }
         }
+        return;
     }
-    return end();
+
+    std::vector<node_pool_type> pools;
+    pools.reserve(chunks);
+    for (size_type t = 0; t < chunks; ++t)
+        pools.emplace_back(pool.get_allocator());
+    std::vector<std::vector<Node*>> copies(chunks);
+    std::vector<std::exception_ptr> errors(chunks);
+
+    auto run = [&](size_type t) {
+        size_type first = source.bucket_count_ / chunks * t;
+        size_type last = t + 1 == chunks ? source.bucket_count_ : source.bucket_count_ / chunks * (t + 1);
+        try {
+            for (size_type i = first; i < last; ++i) {
+                for (const Node* node = source.bucket_begin(i); node; node = source.bucket_next(node, i))
+                    copy_node(node, pools[t], [&](Node* copy) { copies[t].push_back(copy); });
+            }
+        }
+        catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    try {
+        for (size_type t = 1; t < chunks; ++t)
+            workers.emplace_back(run, t);
+    }
+    catch (...) {
+        // Could not start a thread: the remaining ranges run on this one.
+        for (size_type t = workers.size() + 1; t < chunks; ++t)
+            run(t);
+    }
+    run(0);
+    for (auto& worker : workers)
+        worker.join();
+
+    // Room for every source element was reserved above, so this cannot throw.
+    for (size_type t = 0; t < chunks; ++t) {
+        pool.join(pools[t].share());
+        for (Node* copy : copies[t])
+            push_element(copy);
+        num_elements += copies[t].size();
+    }
+    for (auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
 }
 
 /********************************************************************************
- * end() - const_iterator version
+ * emplace_unique
  * ------------------------------------------------------------------------------
- * Returns a const_iterator representing the end of the unordered_set.
+ * Looks up key and, only if it is absent, creates a node from args and links
+ * it. This is the common path of insert, emplace and try_emplace: a hit costs
+ * one hash and a chain walk, and never constructs a value.
+ *
+ * Parameters:
+ *   - key: The lookup key; must compare equal to the value built from args.
+ *   - hash: The mixed hash of key.
+ *   - args: Arguments for constructing the value on a miss.
  *
  * Returns:
- *   - Const iterator representing the past-the-end element.
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::end() const {
-    return const_iterator(this, bucket_count_, nullptr);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename... Args>
+std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator, bool>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::emplace_unique(const K& key, size_type hash, Args&&... args) {
+    rehash_if_needed();
+    if (Node* found = locate(key, hash))
+        return { iterator(this, found), false };
+    Node* new_node = create_node(std::forward<Args>(args)...);
+    return { link_node(new_node, hash), true };
 }
 
 /********************************************************************************
- * cbegin() and cend()
+ * erase_key
  * ------------------------------------------------------------------------------
- * Returns constant iterators to the beginning and end of the unordered_set.
+ * Shared body of the erase-by-key overloads and erase_many. Advances a
+ * pending incremental rehash by one step first, and may shrink the table
+ * afterwards (see shrink_if_needed).
+ *
+ * Parameters:
+ *   - key: The key of the element to remove; key_type or a transparent type.
+ *   - hash: The mixed hash of key.
  *
  * Returns:
- *   - cbegin(): Const iterator to the first element.
- *   - cend(): Const iterator to the past-the-end element.
+ *   - The number of elements removed (0 or 1).
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::cbegin() const {
-    return begin();
-}
-
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::cend() const {
-    return end();
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::erase_key(const K& key, size_type hash) {
+    migrate_step();
+    this->count_lookup();
+    for (Node** link = chain_slot(hash); *link; link = &(*link)->next) {
+        Node* current = *link;
+        if (node_matches(current, key, hash)) {
+            *link = current->next;
+            drop_element(current);
+            destroy_node(current);
+            --num_elements;
+            shrink_if_needed();
+            return 1;
+        }
+    }
+    return 0;
 }
 
 /********************************************************************************
- * empty
+ * migrating
  * ------------------------------------------------------------------------------
- * Checks if the unordered_set has no elements.
+ * Tells whether an incremental rehash is in progress.
  *
  * Returns:
- *   - true if empty, false otherwise.
+ *   - true while old buckets remain to be migrated.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-bool unordered_set<Key, Hash, KeyEqual, Allocator>::empty() const {
-    return num_elements == 0;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::migrating() const {
+    return !old_buckets.empty();
 }
 
 /********************************************************************************
- * size
+ * migrate_bucket
  * ------------------------------------------------------------------------------
- * Retrieves the number of elements in the unordered_set.
+ * Splits one old bucket into the two new buckets it feeds, old_index and
+ * old_index + old_buckets.size(). Relative node order is preserved in both
+ * halves. Both new buckets are written even when empty, since they start out
+ * uninitialized.
+ *
+ * Parameters:
+ *   - old_index: Index of the old bucket; must equal migrated_buckets.
  *
  * Returns:
- *   - Number of elements stored.
+ *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
-unordered_set<Key, Hash, KeyEqual, Allocator>::size() const {
-    return num_elements;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::migrate_bucket(size_type old_index) {
+    size_type old_count = old_buckets.size();
+    Node* low = nullptr;
+    Node* high = nullptr;
+    Node** low_tail = &low;
+    Node** high_tail = &high;
+    for (Node* current = old_buckets[old_index]; current; current = current->next) {
+        if (node_hash(current) & old_count) {
+            *high_tail = current;
+            high_tail = &current->next;
+        }
+        else {
+            *low_tail = current;
+            low_tail = &current->next;
+        }
+    }
+    *low_tail = nullptr;
+    *high_tail = nullptr;
+    buckets[old_index] = low;
+    buckets[old_index + old_count] = high;
 }
 
 /********************************************************************************
- * load_factor
+ * migrate_step
  * ------------------------------------------------------------------------------
- * Computes the load factor of the unordered_set.
+ * Migrates the next few old buckets, bounding the extra work any single
+ * insert or erase does for an incremental rehash. The step is the number of
+ * old buckets left divided by the inserts left before the next doubling,
+ * rounded up, and at least kRehashStep, so the migration always completes
+ * before the next one has to start. Right after a doubling that is about
+ * 1 / max_load_factor buckets, holding about one node on average, whatever
+ * the size. Frees the old bucket array once the last bucket has moved. A
+ * pending compaction of the element array moves on by kCompactStep entries
+ * here too. Does nothing in the default mode.
  *
  * Returns:
- *   - The ratio of num_elements to the number of buckets.
+ *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-float unordered_set<Key, Hash, KeyEqual, Allocator>::load_factor() const {
-    return static_cast<float>(num_elements) / bucket_count_;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::migrate_step() {
+    if constexpr (Traits::incremental_rehash) {
+        if (compacting)
+            compact_step(kCompactStep);
+        if (!migrating())
+            return;
+        auto timer = this->start_timer();
+        size_type remaining = old_buckets.size() - migrated_buckets;
+        size_type threshold = static_cast<size_type>(static_cast<double>(max_load_factor_) * bucket_count_);
+        size_type inserts_left = threshold >= num_elements ? threshold - num_elements + 1 : 1;
+        size_type step = std::max(kRehashStep, (remaining + inserts_left - 1) / inserts_left);
+        size_type stop = migrated_buckets + std::min(step, remaining);
+        for (; migrated_buckets < stop; ++migrated_buckets)
+            migrate_bucket(migrated_buckets);
+        if (migrated_buckets == old_buckets.size()) {
+            old_buckets.clear();
+            migrated_buckets = 0;
+        }
+        this->add_rehash_time(timer);
+    }
 }
 
 /********************************************************************************
- * max_load_factor (getter)
+ * finish_migration
  * ------------------------------------------------------------------------------
- * Returns the current maximum load factor of the unordered_set.
+ * Completes a pending incremental rehash in one go. Used before operations
+ * that rebuild the bucket array anyway, such as rehash() and clear().
  *
  * Returns:
- *   - Current max load factor.
+ *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-float unordered_set<Key, Hash, KeyEqual, Allocator>::max_load_factor() const {
-    return max_load_factor_;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::finish_migration() {
+    if constexpr (Traits::incremental_rehash) {
+        while (migrated_buckets < old_buckets.size())
+            migrate_bucket(migrated_buckets++);
+        old_buckets.clear();
+        migrated_buckets = 0;
+    }
+}
+
+/********************************************************************************
+ * rehash_if_needed
+ * ------------------------------------------------------------------------------
+ * Checks if the current load factor exceeds the maximum load factor.
+ * If it does, doubles the number of buckets. By default every node is moved
+ * at once. With Traits::incremental_rehash, an uninitialized array of twice
+ * the size replaces the current one, which is kept as old_buckets, and the
+ * nodes then move a few buckets per insert or erase (migrate_step). Any
+ * step left over from a previous doubling is done first. Also makes room in
+ * the element array for the node about to be linked.
+ *
+ * Parameters:
+ *   - None.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::rehash_if_needed() {
+    migrate_step();
+    reserve_elements(1);
+    if (load_factor() > max_load_factor_) {
+        if constexpr (Traits::incremental_rehash) {
+            if (bucket_count_ > 0) {
+                finish_migration();
+                auto timer = this->start_timer();
+                old_buckets = std::move(buckets);
+                buckets = unordered_set_detail::bucket_array<Node*>::uninitialized(bucket_count_ * 2);
+                bucket_count_ *= 2;
+                migrated_buckets = 0;
+                this->count_rehash();
+                this->count_allocator_call();
+                this->add_rehash_time(timer);
+                return;
+            }
+        }
+        rehash(bucket_count_ * 2);
+    }
+}
+
+/********************************************************************************
+ * shrink_if_needed
+ * ------------------------------------------------------------------------------
+ * Called after elements are removed. Squeezes the holes out of the element
+ * array once they outnumber the elements: at once by default, and a few
+ * entries per insert or erase (in migrate_step) with
+ * Traits::incremental_rehash. When a minimum load factor is set and the load
+ * factor has dropped below it, also rehashes down to the bucket count at
+ * which the load factor is half the maximum. That leaves room to double again
+ * before growing, so a size hovering near either threshold does not rehash
+ * back and forth. The table never auto-shrinks below kMinShrinkBuckets
+ * buckets.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::shrink_if_needed() {
+    if (!compacting && elements.size() - num_elements > std::max(num_elements, kMinElementHoles)) {
+        if constexpr (Traits::incremental_rehash) {
+            compacting = true;
+            compact_read = 0;
+            compact_write = 0;
+        }
+        else {
+            compact_elements();
+        }
+    }
+    if (min_load_factor_ > 0 && bucket_count_ > kMinShrinkBuckets && load_factor() < min_load_factor_) {
+        size_type target = static_cast<size_type>(std::ceil(2 * num_elements / max_load_factor_));
+        if (unordered_set_detail::next_power_of_two(std::max(target, kMinShrinkBuckets)) < bucket_count_)
+            rehash(std::max(target, kMinShrinkBuckets));
+    }
+}
+
+/********************************************************************************
+ * Default Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs an unordered_set with default values.
+ * Sets an initial bucket count of 16, a max load factor of 1.0 and no
+ * minimum load factor.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::unordered_set() 
+    : bucket_count_(16), num_elements(0), max_load_factor_(1.0), min_load_factor_(0.0),
+      hash_func(Hash()), key_eq(KeyEqual()), pool(Allocator()), migrated_buckets(0), slot_offset(0), compacting(false), compact_read(0), compact_write(0)
+{
+    buckets.assign(bucket_count_, nullptr);
+}
+
+/********************************************************************************
+ * Constructor with bucket_count_
+ * ------------------------------------------------------------------------------
+ * Constructs an unordered_set with a user-defined bucket count, hash functor,
+ * key equality function, and allocator. The bucket count is rounded up to a
+ * power of two.
+ *
+ * Parameters:
+ *   - bucket_count_: Initial number of buckets.
+ *   - hash_func_: Hash function for keys.
+ *   - equal: Equality function for keys.
+ *   - alloc_: Allocator to use.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::unordered_set(size_type bucket_count_, 
+                                                              const hasher& hash_func_, 
+                                                              const key_equal& equal, 
+                                                              const allocator_type& alloc_) 
+    : bucket_count_(bucket_count_ > 0 ? unordered_set_detail::next_power_of_two(bucket_count_) : 16), num_elements(0),
+      max_load_factor_(1.0), min_load_factor_(0.0),
+      hash_func(hash_func_), key_eq(equal), pool(alloc_), migrated_buckets(0), slot_offset(0), compacting(false), compact_read(0), compact_write(0)
+{
+    buckets.assign(this->bucket_count_, nullptr);
+}
+
+/********************************************************************************
+ * Initializer List Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs an unordered_set using an initializer_list, with an optional initial
+ * bucket count, hash functor, key equality function, and allocator.
+ *
+ * Parameters:
+ *   - init: Initializer list of values.
+ *   - bucket_count_: Initial bucket count (optional).
+ *   - hash_func_: Hash function.
+ *   - equal: Equality function.
+ *   - alloc_: Allocator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::unordered_set(
+    std::initializer_list<value_type> init,
+    size_type bucket_count_,
+    const hasher& hash_func_,
+    const key_equal& equal,
+    const allocator_type& alloc_)
+    : unordered_set(bucket_count_ ? bucket_count_ : init.size(), hash_func_, equal, alloc_)
+{
+    for (const auto& val : init) {
+        insert(val);
+    }
+}
+
+/********************************************************************************
+ * Copy Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs a new unordered_set as a copy of an existing one, with the same
+ * bucket count. The copies are linked directly (see clone_from).
+ *
+ * Parameters:
+ *   - other: The unordered_set to copy.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::unordered_set(const unordered_set& other)
+    : counters_base(), bucket_count_(other.bucket_count_), num_elements(0),
+      max_load_factor_(other.max_load_factor_), min_load_factor_(other.min_load_factor_), hash_func(other.hash_func),
+      key_eq(other.key_eq), pool(other.pool), migrated_buckets(0), slot_offset(0), compacting(false), compact_read(0), compact_write(0)
+{
+    buckets.assign(bucket_count_, nullptr);
+    clone_from(other);
+}
+
+/********************************************************************************
+ * Move Constructor
+ * ------------------------------------------------------------------------------
+ * Constructs a new unordered_set by moving an existing one.
+ *
+ * Parameters:
+ *   - other: The unordered_set to move from.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::unordered_set(unordered_set&& other) noexcept
+    : buckets(std::move(other.buckets)), bucket_count_(other.bucket_count_),
+      num_elements(other.num_elements), max_load_factor_(other.max_load_factor_), min_load_factor_(other.min_load_factor_),
+      hash_func(std::move(other.hash_func)), key_eq(std::move(other.key_eq)), pool(std::move(other.pool)),
+      old_buckets(std::move(other.old_buckets)), migrated_buckets(other.migrated_buckets),
+      elements(std::move(other.elements)), slot_offset(other.slot_offset), compacting(other.compacting),
+      compact_read(other.compact_read), compact_write(other.compact_write)
+{
+    other.bucket_count_ = 0;
+    other.migrated_buckets = 0;
+    other.num_elements = 0;
+    other.elements.clear();
+    other.compacting = false;
+}
+
+/********************************************************************************
+ * Copy Assignment Operator
+ * ------------------------------------------------------------------------------
+ * Assigns the contents of one unordered_set to another using copying. If an
+ * element copy throws, this container is left empty.
+ *
+ * Parameters:
+ *   - other: The unordered_set to copy from.
+ *
+ * Returns:
+ *   - Reference to this unordered_set.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>&
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::operator=(const unordered_set& other) {
+    if (this != &other) {
+        clear();
+        bucket_count_ = other.bucket_count_;
+        max_load_factor_ = other.max_load_factor_;
+        min_load_factor_ = other.min_load_factor_;
+        hash_func = other.hash_func;
+        key_eq = other.key_eq;
+        pool = other.pool;
+        buckets.assign(bucket_count_, nullptr);
+        clone_from(other);
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * Move Assignment Operator
+ * ------------------------------------------------------------------------------
+ * Assigns the contents of one unordered_set to another using move semantics.
+ * The nodes are taken over when the allocators allow it; otherwise each value
+ * is moved out of other's node into a node from this container's allocator,
+ * without lookups, since the keys are already unique. Only that path can
+ * throw, so the operator is noexcept whenever the allocator propagates on
+ * move assignment or always compares equal.
+ *
+ * Parameters:
+ *   - other: The unordered_set to move from.
+ *
+ * Returns:
+ *   - Reference to this unordered_set.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>&
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::operator=(unordered_set&& other) noexcept(kNothrowMoveAssign) {
+    if (this != &other) {
+        clear();
+        max_load_factor_ = other.max_load_factor_;
+        min_load_factor_ = other.min_load_factor_;
+        hash_func = std::move(other.hash_func);
+        key_eq = std::move(other.key_eq);
+        if (pool.can_adopt(other.pool)) {
+            buckets = std::move(other.buckets);
+            old_buckets = std::move(other.old_buckets);
+            bucket_count_ = other.bucket_count_;
+            num_elements = other.num_elements;
+            migrated_buckets = other.migrated_buckets;
+            elements = std::move(other.elements);
+            slot_offset = other.slot_offset;
+            compacting = other.compacting;
+            compact_read = other.compact_read;
+            compact_write = other.compact_write;
+            pool = std::move(other.pool);
+            other.bucket_count_ = 0;
+            other.num_elements = 0;
+            other.migrated_buckets = 0;
+            other.elements.clear();
+            other.compacting = false;
+        }
+        else {
+            // other's nodes live in an arena this allocator cannot free, so move the values instead.
+            buckets.assign(other.bucket_count_, nullptr);
+            bucket_count_ = other.bucket_count_;
+            reserve_elements(other.num_elements);
+            for (size_type i = 0; i < other.elements.size(); ++i) {
+                if (Node* node = other.elements[i]) {
+                    size_type hash = transferred_hash(node);
+                    link_node(create_node(std::move(node->value)), hash);
+                }
+            }
+            other.clear();
+        }
+    }
+    return *this;
+}
+
+/********************************************************************************
+ * Destructor
+ * ------------------------------------------------------------------------------
+ * Destroys the unordered_set and releases all allocated resources.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::~unordered_set() {
+    clear();
+}
+
+/********************************************************************************
+ * get_allocator
+ * ------------------------------------------------------------------------------
+ * Returns a copy of the allocator that supplies the node slabs.
+ *
+ * Returns:
+ *   - The container's allocator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::allocator_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::get_allocator() const {
+    return pool.get_allocator();
+}
+
+/********************************************************************************
+ * iterator::operator++ (Prefix)
+ * ------------------------------------------------------------------------------
+ * Advances the iterator to the next element in the container's element
+ * array. The cost of walking the whole container is proportional to its
+ * size, however many buckets it has.
+ *
+ * Returns:
+ *   - Reference to the updated iterator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator&
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator::operator++() {
+    current = container->element_after(current);
+    return *this;
+}
+
+/********************************************************************************
+ * iterator::operator++ (Postfix)
+ * ------------------------------------------------------------------------------
+ * Advances the iterator to the next element, returning the original value.
+ *
+ * Returns:
+ *   - Iterator pointing to the element before the increment.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator::operator++(int) {
+    iterator tmp = *this;
+    ++(*this);
+    return tmp;
+}
+
+/********************************************************************************
+ * iterator::operator== and operator!=
+ * ------------------------------------------------------------------------------
+ * Compares two iterators for equality and inequality.
+ *
+ * Returns:
+ *   - true if both iterators point to the same container location, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator::operator==(const iterator &other) const {
+    return container == other.container && current == other.current;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator::operator!=(const iterator &other) const {
+    return !(*this == other);
+}
+
+/********************************************************************************
+ * const_iterator::operator++ (Prefix)
+ * ------------------------------------------------------------------------------
+ * Advances the const_iterator to the next element in the container's
+ * element array.
+ *
+ * Returns:
+ *   - Reference to the updated const_iterator.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator&
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator::operator++() {
+    current = container->element_after(current);
+    return *this;
+}
+
+/********************************************************************************
+ * const_iterator::operator++ (Postfix)
+ * ------------------------------------------------------------------------------
+ * Advances the const_iterator to the next element, returning its previous state.
+ *
+ * Returns:
+ *   - Const iterator pointing to the element before the increment.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator::operator++(int) {
+    const_iterator tmp = *this;
+    ++(*this);
+    return tmp;
+}
+
+/********************************************************************************
+ * const_iterator::operator== and operator!=
+ * ------------------------------------------------------------------------------
+ * Compares two const_iterators for equality and inequality.
+ *
+ * Returns:
+ *   - true if both const_iterators point to the same container location, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator::operator==(const const_iterator &other) const {
+    return container == other.container && current == other.current;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator::operator!=(const const_iterator &other) const {
+    return !(*this == other);
+}
+
+/********************************************************************************
+ * begin() - iterator version
+ * ------------------------------------------------------------------------------
+ * Returns an iterator to the first element in the unordered_set.
+ *
+ * Returns:
+ *   - Iterator to the first element, or end() if the container is empty.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::begin() {
+    return iterator(this, first_element());
+}
+
+/********************************************************************************
+ * end() - iterator version
+ * ------------------------------------------------------------------------------
+ * Returns an iterator representing the end of the unordered_set.
+ *
+ * Returns:
+ *   - Iterator representing the past-the-end element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::end() {
+    return iterator(this, nullptr);
+}
+
+/********************************************************************************
+ * begin() - const_iterator version
+ * ------------------------------------------------------------------------------
+ * Returns a const_iterator to the first element in the unordered_set.
+ *
+ * Returns:
+ *   - Const iterator to the first element, or end() if the container is empty.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::begin() const {
+    return const_iterator(this, first_element());
+}
+
+/********************************************************************************
+ * end() - const_iterator version
+ * ------------------------------------------------------------------------------
+ * Returns a const_iterator representing the end of the unordered_set.
+ *
+ * Returns:
+ *   - Const iterator representing the past-the-end element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::end() const {
+    return const_iterator(this, nullptr);
+}
+
+/********************************************************************************
+ * cbegin() and cend()
+ * ------------------------------------------------------------------------------
+ * Returns constant iterators to the beginning and end of the unordered_set.
+ *
+ * Returns:
+ *   - cbegin(): Const iterator to the first element.
+ *   - cend(): Const iterator to the past-the-end element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::cbegin() const {
+    return begin();
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::cend() const {
+    return end();
+}
+
+/********************************************************************************
+ * empty
+ * ------------------------------------------------------------------------------
+ * Checks if the unordered_set has no elements.
+ *
+ * Returns:
+ *   - true if empty, false otherwise.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::empty() const {
+    return num_elements == 0;
+}
+
+/********************************************************************************
+ * size
+ * ------------------------------------------------------------------------------
+ * Retrieves the number of elements in the unordered_set.
+ *
+ * Returns:
+ *   - Number of elements stored.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size() const {
+    return num_elements;
+}
+
+/********************************************************************************
+ * load_factor
+ * ------------------------------------------------------------------------------
+ * Computes the load factor of the unordered_set.
+ *
+ * Returns:
+ *   - The ratio of num_elements to the number of buckets.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+float unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::load_factor() const {
+    return static_cast<float>(num_elements) / bucket_count_;
+}
+
+/********************************************************************************
+ * max_load_factor (getter)
+ * ------------------------------------------------------------------------------
+ * Returns the current maximum load factor of the unordered_set.
+ *
+ * Returns:
+ *   - Current max load factor.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+float unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::max_load_factor() const {
+    return max_load_factor_;
+}
+
+/********************************************************************************
+ * max_load_factor (setter)
+ * ------------------------------------------------------------------------------
+ * Sets a new maximum load factor. If the table is now over it, it is rebuilt
+ * in one go with enough buckets, finishing any pending incremental rehash,
+ * rather than doubling once per insert.
+ *
+ * Parameters:
+ *   - ml: The new maximum load factor.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::max_load_factor(float ml) {
+    max_load_factor_ = ml;
+    if (load_factor() > max_load_factor_)
+        rehash(0);
+}
+
+/********************************************************************************
+ * min_load_factor (getter)
+ * ------------------------------------------------------------------------------
+ * Returns the load factor below which erasing shrinks the table; 0 (the
+ * default) disables automatic shrinking.
+ *
+ * Returns:
+ *   - Current min load factor.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+float unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::min_load_factor() const {
+    return min_load_factor_;
+}
+
+/********************************************************************************
+ * min_load_factor (setter)
+ * ------------------------------------------------------------------------------
+ * Sets the load factor below which erase and extract shrink the table, and
+ * shrinks it right away if it is already below. Values well under
+ * max_load_factor() / 2, such as max_load_factor() / 8, keep a table whose
+ * size swings back and forth from rehashing on every swing.
+ *
+ * Parameters:
+ *   - ml: The new minimum load factor; 0 disables automatic shrinking.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::min_load_factor(float ml) {
+    min_load_factor_ = ml;
+    shrink_if_needed();
+}
+
+/********************************************************************************
+ * clear
+ * ------------------------------------------------------------------------------
+ * Removes all elements from the unordered_set and frees their memory. Node
+ * storage is released a whole slab at a time, and values with destructors are
+ * destroyed through the element array. In a sparse table only the buckets of
+ * the elements are reset, so the cost follows size() rather than the bucket
+ * count; the bucket count itself is kept (see shrink_to_fit).
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::clear() {
+    if (migrating() || num_elements * kSparseClearRatio >= bucket_count_) {
+        std::fill(buckets.begin(), buckets.end(), nullptr);
+    }
+    else {
+        for (size_type i = 0; i < elements.size(); ++i)
+            if (Node* node = elements[i])
+                buckets[bucket_index(node_hash(node))] = nullptr;
+    }
+    if constexpr (!std::is_trivially_destructible<value_type>::value) {
+        for (size_type i = 0; i < elements.size(); ++i)
+            if (Node* node = elements[i])
+                node->value.~value_type();
+    }
+    elements.clear();
+    slot_offset = 0;
+    compacting = false;
+    old_buckets.clear();
+    migrated_buckets = 0;
+    num_elements = 0;
+    pool.release();
+}
+
+/********************************************************************************
+ * insert (lvalue)
+ * ------------------------------------------------------------------------------
+ * Inserts an element into the unordered_set by copying.
+ * If the key already exists, the insertion is ignored and nothing is copied.
+ *
+ * Parameters:
+ *   - value: The value to insert.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted element (or existing element)
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator, bool>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert(const value_type& value) {
+    return emplace_unique(value, hash_of(value), value);
+}
+
+/********************************************************************************
+ * insert (rvalue)
+ * ------------------------------------------------------------------------------
+ * Inserts an element into the unordered_set by moving.
+ * If the key already exists, the insertion is ignored and value is left intact.
+ *
+ * Parameters:
+ *   - value: The rvalue reference to the value to insert.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator, bool>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert(value_type&& value) {
+    return emplace_unique(value, hash_of(value), std::move(value));
+}
+
+/********************************************************************************
+ * insert (with hint)
+ * ------------------------------------------------------------------------------
+ * Inserts an element, using hint as a shortcut: if hint already points to an
+ * equal element it is returned without hashing. Otherwise this behaves like
+ * insert(value).
+ *
+ * Parameters:
+ *   - hint: Iterator to a likely equal element, or any valid iterator.
+ *   - value: The value to insert (copied or moved).
+ *
+ * Returns:
+ *   - Iterator to the inserted or existing element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert(const_iterator hint, const value_type& value) {
+    return emplace_hint(hint, value);
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert(const_iterator hint, value_type&& value) {
+    return emplace_hint(hint, std::move(value));
+}
+
+/********************************************************************************
+ * emplace
+ * ------------------------------------------------------------------------------
+ * Inserts an element constructed in-place into the unordered_set.
+ * Perfectly forwards the arguments to the element constructor. A single
+ * value_type argument is looked up first and only copied or moved on a miss.
+ * Otherwise the value is built directly in a pooled node; on a hit that node
+ * goes straight back to the free list, so no temporary is moved around and
+ * nothing reaches the allocator.
+ *
+ * Parameters:
+ *   - args: Arguments for constructing a new element.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename... Args>
+std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator, bool>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::emplace(Args&&... args) {
+    if constexpr (sizeof...(Args) == 1 && std::conjunction<std::is_same<std::decay_t<Args>, value_type>...>::value) {
+        return emplace_unique(args..., hash_of(args...), std::forward<Args>(args)...);
+    }
+    else {
+        rehash_if_needed();
+        Node* new_node = create_node(std::forward<Args>(args)...);
+        try {
+            size_type hash = hash_of(new_node->value);
+            if (Node* found = locate(new_node->value, hash)) {
+                destroy_node(new_node);
+                return { iterator(this, found), false };
+            }
+            return { link_node(new_node, hash), true };
+        }
+        catch (...) {
+            destroy_node(new_node);
+            throw;
+        }
+    }
+}
+
+/********************************************************************************
+ * emplace_hint
+ * ------------------------------------------------------------------------------
+ * Like emplace, but first checks whether hint already points to an element
+ * equal to a single value_type argument, in which case nothing is hashed.
+ *
+ * Parameters:
+ *   - hint: Iterator to a likely equal element, or any valid iterator.
+ *   - args: Arguments for constructing a new element.
+ *
+ * Returns:
+ *   - Iterator to the inserted or existing element.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename... Args>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::emplace_hint(const_iterator hint, Args&&... args) {
+    if constexpr (sizeof...(Args) == 1 && std::conjunction<std::is_same<std::decay_t<Args>, value_type>...>::value) {
+        if (hint.container == this && hint.current && key_eq(hint.current->value, args...))
+            return iterator(this, const_cast<Node*>(hint.current));
+    }
+    return emplace(std::forward<Args>(args)...).first;
+}
+
+/********************************************************************************
+ * try_emplace
+ * ------------------------------------------------------------------------------
+ * Hashes and looks up key first, and constructs the stored value only if key
+ * is absent. With no further arguments the value is built from key itself;
+ * otherwise from args, which must produce a value equal to key. key may be
+ * any type accepted by transparent Hash and KeyEqual, e.g. a std::string_view
+ * for std::string elements.
+ *
+ * Parameters:
+ *   - key: The lookup key.
+ *   - args: Optional arguments for constructing the value.
+ *
+ * Returns:
+ *   - Pair consisting of an iterator to the inserted (or existing) element
+ *     and a bool indicating whether the insertion took place.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename... Args, typename>
+std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator, bool>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::try_emplace(K&& key, Args&&... args) {
+    if constexpr (sizeof...(Args) == 0)
+        return emplace_unique(key, hash_of(key), std::forward<K>(key));
+    else
+        return emplace_unique(key, hash_of(key), std::forward<Args>(args)...);
 }
 
 /********************************************************************************
- * max_load_factor (setter)
+ * erase (by key)
  * ------------------------------------------------------------------------------
- * Sets a new maximum load factor and rehashes the container if necessary.
+ * Erases the element corresponding to the specified key. The template overload
+ * accepts any type usable with transparent Hash and KeyEqual.
  *
  * Parameters:
- *   - ml: The new maximum load factor.
+ *   - key: The key of the element to remove.
  *
  * Returns:
- *   - None.
+ *   - The number of elements removed (0 or 1).
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-void unordered_set<Key, Hash, KeyEqual, Allocator>::max_load_factor(float ml) {
-    max_load_factor_ = ml;
-    rehash_if_needed();
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::erase(const key_type& key) {
+    return erase_key(key, hash_of(key));
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::erase(const K& key) {
+    return erase_key(key, hash_of(key));
 }
 
 /********************************************************************************
- * clear
+ * erase (by const_iterator)
  * ------------------------------------------------------------------------------
- * Removes all elements from the unordered_set and frees their memory.
+ * Erases the element at the given const_iterator position. The following
+ * position is found before the node is unlinked, so erasing while iterating
+ * works in both rehash modes, and it survives the shrinking that may follow.
+ *
+ * Parameters:
+ *   - pos: Const iterator pointing to the element to erase.
  *
  * Returns:
- *   - None.
+ *   - Iterator pointing to the element following the erased element.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-void unordered_set<Key, Hash, KeyEqual, Allocator>::clear() {
-    for (size_type i = 0; i < bucket_count_; ++i) {
-        Node* current = buckets[i];
-        while (current) {
-            Node* temp = current;
-            current = current->next;
-            destroy_node(temp);
-        }
-        buckets[i] = nullptr;
-    }
-    num_elements = 0;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::erase(const_iterator pos) {
+    if (pos.container != this || pos.current == nullptr)
+        return end();
+
+    migrate_step();
+    Node* next = element_after(pos.current);
+    Node* node = unlink_node(pos);
+    if (!node)
+        return end();
+    destroy_node(node);
+    shrink_if_needed();
+    return iterator(this, next);
 }
 
 /********************************************************************************
- * insert (lvalue)
+ * erase (by iterator)
  * ------------------------------------------------------------------------------
- * Inserts an element into the unordered_set by copying.
- * If the key already exists, the insertion is ignored.
+ * Erases the element at the given iterator position.
  *
  * Parameters:
- *   - value: The value to insert.
+ *   - pos: Iterator pointing to the element to erase.
  *
  * Returns:
- *   - Pair consisting of an iterator to the inserted element (or existing element)
- *     and a bool indicating whether the insertion took place.
+ *   - Iterator pointing to the element following the erased element.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
-unordered_set<Key, Hash, KeyEqual, Allocator>::insert(const value_type& value) {
-    rehash_if_needed();
-    size_type index = hash_func(value) % bucket_count_;
-    Node* cur = buckets[index];
-    while (cur) {
-        if (key_eq(cur->value, value))
-            return { iterator(this, index, cur), false };
-        cur = cur->next;
-    }
-    Node* new_node = create_node(value);
-    new_node->next = buckets[index];
-    buckets[index] = new_node;
-    ++num_elements;
-    return { iterator(this, index, new_node), true };
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::erase(iterator pos) {
+    return erase(const_iterator(pos));
 }
 
 /********************************************************************************
- * insert (rvalue)
+ * find (non-const version)
  * ------------------------------------------------------------------------------
- * Inserts an element into the unordered_set by moving.
- * If the key already exists, the insertion is ignored.
+ * Searches for the element with the given key. The template overload accepts
+ * any type usable with transparent Hash and KeyEqual without building a key_type.
  *
  * Parameters:
- *   - value: The rvalue reference to the value to insert.
+ *   - key: The key of the element to find.
  *
  * Returns:
- *   - Pair consisting of an iterator to the inserted (or existing) element
- *     and a bool indicating whether the insertion took place.
+ *   - Iterator pointing to the found element, or end() if not found.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
-unordered_set<Key, Hash, KeyEqual, Allocator>::insert(value_type&& value) {
-    rehash_if_needed();
-    size_type index = hash_func(value) % bucket_count_;
-    Node* cur = buckets[index];
-    while (cur) {
-        if (key_eq(cur->value, value))
-            return { iterator(this, index, cur), false };
-        cur = cur->next;
-    }
-    Node* new_node = create_node(std::move(value));
-    new_node->next = buckets[index];
-    buckets[index] = new_node;
-    ++num_elements;
-    return { iterator(this, index, new_node), true };
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::find(const key_type& key) {
+    return iterator(this, locate(key, hash_of(key)));
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::find(const K& key) {
+    return iterator(this, locate(key, hash_of(key)));
 }
 
 /********************************************************************************
- * emplace
+ * find (const version)
  * ------------------------------------------------------------------------------
- * Inserts an element constructed in-place into the unordered_set.
- * Perfectly forwards the arguments to the element constructor.
+ * Searches for the element with the given key, returning a const_iterator.
  *
  * Parameters:
- *   - args: Arguments for constructing a new element.
+ *   - key: The key of the element to find.
  *
  * Returns:
- *   - Pair consisting of an iterator to the inserted (or existing) element
- *     and a bool indicating whether the insertion took place.
+ *   - Const iterator pointing to the found element, or end() if not found.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-template<typename... Args>
-std::pair<typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator, bool>
-unordered_set<Key, Hash, KeyEqual, Allocator>::emplace(Args&&... args) {
-    value_type temp(std::forward<Args>(args)...);
-    return insert(std::move(temp));
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::find(const key_type& key) const {
+    return const_iterator(this, locate(key, hash_of(key)));
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::const_iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::find(const K& key) const {
+    return const_iterator(this, locate(key, hash_of(key)));
 }
 
 /********************************************************************************
- * erase (by key)
+ * count
  * ------------------------------------------------------------------------------
- * Erases the element corresponding to the specified key.
+ * Counts the elements matching the given key.
+ * Since unordered_set does not allow duplicate keys, this function returns 0 or 1.
  *
  * Parameters:
- *   - key: The key of the element to remove.
+ *   - key: The key to count.
  *
  * Returns:
- *   - The number of elements removed (0 or 1).
+ *   - 1 if found, 0 otherwise.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
-unordered_set<Key, Hash, KeyEqual, Allocator>::erase(const key_type& key) {
-    size_type index = hash_func(key) % bucket_count_;
-    Node* current = buckets[index];
-    Node* prev = nullptr;
-    while (current) {
-        if (key_eq(current->value, key)) {
-            if (prev)
-                prev->next = current->next;
-            else
-                buckets[index] = current->next;
-            destroy_node(current);
-            --num_elements;
-            return 1;
-        }
-        prev = current;
-        current = current->next;
-    }
-    return 0;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::count(const key_type& key) const {
+    return locate(key, hash_of(key)) ? 1 : 0;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::count(const K& key) const {
+    return locate(key, hash_of(key)) ? 1 : 0;
 }
 
 /********************************************************************************
- * erase (by const_iterator)
+ * contains
  * ------------------------------------------------------------------------------
- * Erases the element at the given const_iterator position.
+ * Checks whether an element equal to key is present.
  *
  * Parameters:
- *   - pos: Const iterator pointing to the element to erase.
+ *   - key: The key to look for; key_type or a transparent lookup type.
  *
  * Returns:
- *   - Iterator pointing to the element following the erased element.
+ *   - true if found, false otherwise.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::erase(const_iterator pos) {
-    if (pos.container != this || pos.current == nullptr)
-        return end();
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::contains(const key_type& key) const {
+    return locate(key, hash_of(key)) != nullptr;
+}
 
-    size_type index = pos.bucket_index;
-    Node* current = buckets[index];
-    Node* prev = nullptr;
-    while (current) {
-        if (current == pos.current) {
-            if (prev)
-                prev->next = current->next;
-            else
-                buckets[index] = current->next;
-            destroy_node(current);
-            --num_elements;
-            iterator ret(this, index, nullptr);
-            if (prev && prev->next)
-                ret.current = prev->next;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+bool unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::contains(const K& key) const {
+    return locate(key, hash_of(key)) != nullptr;
+}
+
+/********************************************************************************
+ * find_many
+ * ------------------------------------------------------------------------------
+ * Looks up n keys as a software pipeline, the way a pipelined hash join
+ * probes. While key i is resolved, the chain head of key i + D is already
+ * being prefetched and the bucket slot of key i + 2D is being hashed and
+ * prefetched (D = kPrefetchDistance), so the two dependent cache misses of
+ * each lookup overlap with those of the keys around it.
+ *
+ * Parameters:
+ *   - keys: Array of n keys; key_type or a transparent lookup type.
+ *   - n: Number of keys.
+ *   - out_bitmap: Array of at least (n + 63) / 64 words. Bit i is set if
+ *     keys[i] is present and cleared otherwise.
+ *
+ * Returns:
+ *   - The number of keys found.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::find_many(const K* keys, size_type n, std::uint64_t* out_bitmap) const {
+    constexpr size_type kLag = 2 * kPrefetchDistance;
+    constexpr size_type kRing = 2 * kLag;
+    size_type hashes[kRing];
+    Node* heads[kRing];
+    size_type found = 0;
+    for (size_type i = 0; i < n + kLag; ++i) {
+        if (i < n) {
+            hashes[i % kRing] = hash_of(keys[i]);
+            unordered_set_detail::prefetch(chain_slot(hashes[i % kRing]));
+        }
+        if (i >= kPrefetchDistance && i - kPrefetchDistance < n) {
+            size_type slot = (i - kPrefetchDistance) % kRing;
+            heads[slot] = *chain_slot(hashes[slot]);
+            if (heads[slot])
+                unordered_set_detail::prefetch(heads[slot]);
+        }
+        if (i >= kLag) {
+            size_type k = i - kLag;
+            this->count_lookup();
+            Node* current = heads[k % kRing];
+            while (current && !node_matches(current, keys[k], hashes[k % kRing]))
+                current = current->next;
+            std::uint64_t mask = std::uint64_t(1) << (k % 64);
+            if (current) {
+                out_bitmap[k / 64] |= mask;
+                ++found;
+            }
             else {
-                size_type next_index = index;
-                do {
-                    ++next_index;
-                } while (next_index < bucket_count_ && buckets[next_index] == nullptr);
-                ret.bucket_index = next_index;
-                ret.current = (next_index < bucket_count_ ? buckets[next_index] : nullptr);
+                out_bitmap[k / 64] &= ~mask;
             }
-            return ret;
         }
-        prev = current;
-        current = current->next;
     }
-    return end();
+    return found;
 }
 
 /********************************************************************************
- * erase (by iterator)
+ * insert_range
  * ------------------------------------------------------------------------------
- * Erases the element at the given iterator position.
+ * Inserts every value in [first, last). For forward iterators the table is
+ * reserved once for the whole range, so no intermediate doubling happens.
+ * When they also yield lvalues of value_type, the values are inserted through
+ * the same prefetching pipeline as find_many; other ranges are emplaced one
+ * value at a time.
  *
  * Parameters:
- *   - pos: Iterator pointing to the element to erase.
+ *   - first, last: The range of values to insert.
  *
  * Returns:
- *   - Iterator pointing to the element following the erased element.
+ *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::erase(iterator pos) {
-    if (pos.container != this || pos.current == nullptr)
-        return end();
-
-    size_type index = pos.bucket_index;
-    Node* current = buckets[index];
-    Node* prev = nullptr;
-    while (current) {
-        if (current == pos.current) {
-            if (prev)
-                prev->next = current->next;
-            else
-                buckets[index] = current->next;
-            destroy_node(current);
-            --num_elements;
-            iterator ret(this, index, nullptr);
-            if (prev && prev->next)
-                ret.current = prev->next;
-            else {
-                size_type next_index = index;
-                do {
-                    ++next_index;
-                } while (next_index < bucket_count_ && buckets[next_index] == nullptr);
-                ret.bucket_index = next_index;
-                ret.current = (next_index < bucket_count_ ? buckets[next_index] : nullptr);
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename InputIt>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert_range(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    using reference = typename std::iterator_traits<InputIt>::reference;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+        size_type n = static_cast<size_type>(std::distance(first, last));
+        reserve(size() + n);
+        if constexpr (std::is_lvalue_reference<reference>::value &&
+                      std::is_same<std::remove_cv_t<std::remove_reference_t<reference>>, value_type>::value) {
+            constexpr size_type kLag = 2 * kPrefetchDistance;
+            constexpr size_type kRing = 2 * kLag;
+            size_type hashes[kRing];
+            InputIt resolve = first;
+            for (size_type i = 0; i < n + kLag; ++i) {
+                if (i < n) {
+                    hashes[i % kRing] = hash_of(*first);
+                    unordered_set_detail::prefetch(chain_slot(hashes[i % kRing]));
+                    ++first;
+                }
+                if (i >= kPrefetchDistance && i - kPrefetchDistance < n) {
+                    Node* head = *chain_slot(hashes[(i - kPrefetchDistance) % kRing]);
+                    if (head)
+                        unordered_set_detail::prefetch(head);
+                }
+                if (i >= kLag) {
+                    emplace_unique(*resolve, hashes[(i - kLag) % kRing], *resolve);
+                    ++resolve;
+                }
             }
-            return ret;
         }
-        prev = current;
-        current = current->next;
+        else {
+            for (; first != last; ++first)
+                emplace(*first);
+        }
+    }
+    else {
+        for (; first != last; ++first)
+            emplace(*first);
     }
-    return end();
 }
 
 /********************************************************************************
- * find (non-const version)
+ * erase_many
  * ------------------------------------------------------------------------------
- * Searches for the element with the given key.
+ * Erases n keys through the same prefetching pipeline as find_many.
  *
  * Parameters:
- *   - key: The key of the element to find.
+ *   - keys: Array of n keys; key_type or a transparent lookup type.
+ *   - n: Number of keys.
  *
  * Returns:
- *   - Iterator pointing to the found element, or end() if not found.
+ *   - The number of elements removed.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::find(const key_type& key) {
-    size_type index = hash_func(key) % bucket_count_;
-    Node* current = buckets[index];
-    while (current) {
-        if (key_eq(current->value, key))
-            return iterator(this, index, current);
-        current = current->next;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+template<typename K, typename>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::size_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::erase_many(const K* keys, size_type n) {
+    constexpr size_type kLag = 2 * kPrefetchDistance;
+    constexpr size_type kRing = 2 * kLag;
+    size_type hashes[kRing];
+    size_type erased = 0;
+    for (size_type i = 0; i < n + kLag; ++i) {
+        if (i < n) {
+            hashes[i % kRing] = hash_of(keys[i]);
+            unordered_set_detail::prefetch(chain_slot(hashes[i % kRing]));
+        }
+        if (i >= kPrefetchDistance && i - kPrefetchDistance < n) {
+            Node* head = *chain_slot(hashes[(i - kPrefetchDistance) % kRing]);
+            if (head)
+                unordered_set_detail::prefetch(head);
+        }
+        if (i >= kLag)
+            erased += erase_key(keys[i - kLag], hashes[(i - kLag) % kRing]);
     }
-    return end();
+    return erased;
 }
 
 /********************************************************************************
- * find (const version)
+ * extract
  * ------------------------------------------------------------------------------
- * Searches for the element with the given key, returning a const_iterator.
+ * Unlinks an element and hands it over in a node handle, without copying or
+ * moving the value. The handle keeps the node's slab alive, so it may outlive
+ * this container. Advances a pending incremental rehash by one step, and may
+ * shrink the table afterwards like erase.
  *
  * Parameters:
- *   - key: The key of the element to find.
+ *   - pos: Iterator to the element to extract, or
+ *   - key: Key of the element to extract.
  *
  * Returns:
- *   - Const iterator pointing to the found element, or end() if not found.
+ *   - A handle owning the element, or an empty handle if there was none.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::const_iterator
-unordered_set<Key, Hash, KeyEqual, Allocator>::find(const key_type& key) const {
-    size_type index = hash_func(key) % bucket_count_;
-    const Node* current = buckets[index];
-    while (current) {
-        if (key_eq(current->value, key))
-            return const_iterator(this, index, current);
-        current = current->next;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::node_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::extract(const_iterator pos) {
+    if (pos.container != this || pos.current == nullptr)
+        return node_type();
+
+    migrate_step();
+    Node* node = unlink_node(pos);
+    if (!node)
+        return node_type();
+    node_type handle(node, pool.share());
+    shrink_if_needed();
+    return handle;
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::node_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::extract(const key_type& key) {
+    Node* found = locate(key, hash_of(key));
+    if (!found)
+        return node_type();
+    return extract(const_iterator(this, found));
+}
+
+/********************************************************************************
+ * insert (node handle)
+ * ------------------------------------------------------------------------------
+ * Links the node owned by nh if no equal element is present. The hash is
+ * recomputed, since the value may have changed while extracted. When the
+ * handle's allocator equals this container's, the node itself is linked and
+ * its slab group joined with this container's pool; otherwise the value is
+ * moved into a new node.
+ *
+ * Parameters:
+ *   - nh: The node handle. Left empty if its node was inserted.
+ *   - hint: Ignored; accepted for std::unordered_set compatibility.
+ *
+ * Returns:
+ *   - position: Iterator to the inserted or already present element, or end()
+ *     if nh was empty.
+ *   - inserted: Whether the node was inserted.
+ *   - node: The handle, still owning the node, if it was not inserted.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert_return_type
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert(node_type&& nh) {
+    if (nh.empty())
+        return { end(), false, node_type() };
+
+    size_type hash = hash_of(nh.node->value);
+    if (Node* found = locate(nh.node->value, hash))
+        return { iterator(this, found), false, std::move(nh) };
+
+    rehash_if_needed();
+    if (!(nh.get_allocator() == pool.get_allocator())) {
+        iterator it = link_node(create_node(std::move(nh.node->value)), hash);
+        nh = node_type();
+        return { it, true, node_type() };
     }
-    return end();
+    pool.join(nh.slabs);
+    Node* node = std::exchange(nh.node, nullptr);
+    nh.slabs.reset();
+    return { link_node(node, hash), true, node_type() };
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+typename unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::iterator
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::insert(const_iterator hint, node_type&& nh) {
+    (void)hint;
+    return insert(std::move(nh)).position;
 }
 
 /********************************************************************************
- * count
+ * merge
  * ------------------------------------------------------------------------------
- * Counts the elements matching the given key.
- * Since unordered_set does not allow duplicate keys, this function returns 0 or 1.
+ * Moves every element of source whose key is not present here into this
+ * container, leaving the duplicates in source. With equal allocators the
+ * nodes themselves are relinked: once the first node moves, the two pools'
+ * slab groups are joined, so a moved node stays valid whichever container is
+ * destroyed first, and cached hash codes are reused when the hasher is
+ * stateless. Merging only duplicates joins nothing. When every node moves,
+ * source's free blocks are handed to this pool, so source keeps no slabs
+ * alive, and this pool then returns slabs left without live nodes (see
+ * node_pool::trim), so repeated merges do not pile up the slabs of merged
+ * sets. With different allocators the values are moved into new nodes
+ * instead. The bucket array is grown once up front. source is walked through
+ * its element array, so the moved elements keep their relative order, and
+ * source may shrink afterwards like after erase.
  *
  * Parameters:
- *   - key: The key to count.
+ *   - source: The container to take elements from.
  *
  * Returns:
- *   - 1 if found, 0 otherwise.
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::merge(unordered_set& source) {
+    if (&source == this || source.num_elements == 0)
+        return;
+
+    bool same_allocator = pool.get_allocator() == source.pool.get_allocator();
+    bool joined = false;
+    source.finish_migration();
+    finish_migration();
+    reserve(num_elements + source.num_elements);
+
+    // Dropping a node can shift the indices of the entries after it, but not
+    // their nodes, so the walk goes from node to node.
+    Node* next = source.first_element();
+    while (Node* node = next) {
+        next = source.element_after(node);
+        size_type hash = transferred_hash(node);
+        if (locate(node->value, hash))
+            continue;
+        Node** link = source.chain_slot(source.node_hash(node));
+        while (*link != node)
+            link = &(*link)->next;
+        if (!same_allocator)
+            link_node(create_node(std::move(node->value)), hash);
+        *link = node->next;
+        source.drop_element(node);
+        --source.num_elements;
+        if (same_allocator) {
+            if (!joined) {
+                pool.join(source.pool.share());
+                joined = true;
+            }
+            link_node(node, hash);
+        }
+        else {
+            source.destroy_node(node);
+        }
+    }
+    if (joined && source.num_elements == 0)
+        pool.adopt_free_blocks(source.pool);
+    if (joined)
+        pool.trim(num_elements);
+    source.shrink_if_needed();
+}
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::merge(unordered_set&& source) {
+    merge(source);
+}
+
+/********************************************************************************
+ * save
+ * ------------------------------------------------------------------------------
+ * Writes the set to a binary snapshot (see snapshotFormat.hpp) that load()
+ * and frozen_unordered_set can read back. The current bucket layout and the
+ * hash of every element are stored, so reading it needs neither rehashing
+ * nor, for a frozen set, any deserialization. The file is written under a
+ * temporary name and renamed into place. Only trivially copyable and
+ * std::string keys are supported.
+ *
+ * Parameters:
+ *   - path: The file to write.
+ *
+ * Returns:
+ *   - None. Throws std::system_error or std::runtime_error if the file cannot
+ *     be written; an existing file at path is then left untouched.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::save(const std::string& path) const {
+    namespace detail = unordered_set_detail;
+    using key_traits = detail::snapshot_key_traits<Key>;
+    static_assert(key_traits::kind != detail::kUnsupportedKeys, "save() needs trivially copyable or std::string keys");
+
+    // A moved-from set has no buckets; it is saved as one empty bucket.
+    size_type saved_buckets = std::max<size_type>(bucket_count_, 1);
+    auto for_each_node = [this](auto&& f) {
+        for (size_type i = 0; i < bucket_count_; ++i)
+            for (const Node* node = bucket_begin(i); node; node = bucket_next(node, i))
+                f(node);
+    };
+
+    detail::snapshot_header header{};
+    std::memcpy(header.magic, detail::kSnapshotMagic, sizeof(header.magic));
+    header.version = detail::kSnapshotVersion;
+    header.key_kind = key_traits::kind;
+    header.key_size = key_traits::size;
+    header.key_align = key_traits::align;
+    header.byte_order = detail::kSnapshotByteOrder;
+    header.element_count = num_elements;
+    header.bucket_count = saved_buckets;
+    header.max_load_factor = max_load_factor_;
+
+    detail::snapshot_writer out(path);
+    out.write_value(header);
+
+    header.bucket_offset = out.align();
+    std::uint64_t start = 0;
+    for (size_type i = 0; i < saved_buckets; ++i) {
+        out.write_value(start);
+        if (i < bucket_count_)
+            for (const Node* node = bucket_begin(i); node; node = bucket_next(node, i))
+                ++start;
+    }
+    out.write_value(start);
+
+    header.hash_offset = out.align();
+    for_each_node([&](const Node* node) { out.write_value(static_cast<std::uint64_t>(node_hash(node))); });
+
+    header.key_offset = out.align();
+    if constexpr (key_traits::kind == detail::kStringKeys) {
+        std::uint64_t offset = 0;
+        for_each_node([&](const Node* node) {
+            out.write_value(offset);
+            offset += node->value.size();
+        });
+        out.write_value(offset);
+        header.char_offset = out.align();
+        for_each_node([&](const Node* node) { out.write(node->value.data(), node->value.size()); });
+    }
+    else {
+        for_each_node([&](const Node* node) { out.write(std::addressof(node->value), sizeof(Key)); });
+        header.char_offset = out.align();
+    }
+
+    header.file_size = out.position();
+    out.rewrite_header(header);
+    out.commit();
+}
+
+/********************************************************************************
+ * load
+ * ------------------------------------------------------------------------------
+ * Replaces the contents with a snapshot written by save(). The bucket array
+ * is allocated once at the saved size and every node is linked straight into
+ * its saved bucket using its saved hash: no lookups, no rehashing, and chains
+ * keep their saved order. The loaded set iterates in file order, like a
+ * frozen_unordered_set opened on the same file. The file is mapped rather
+ * than read into a buffer. This container keeps its hasher, key equality and
+ * allocator; a sample of the saved hashes is checked against the hasher, and
+ * every entry is checked to lie in its bucket.
+ *
+ * Parameters:
+ *   - path: Snapshot written by save().
+ *
+ * Returns:
+ *   - None. Throws std::system_error if the file cannot be mapped and
+ *     std::runtime_error if it is not a valid snapshot for this key type or
+ *     hasher; the contents are then unchanged.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-typename unordered_set<Key, Hash, KeyEqual, Allocator>::size_type
-unordered_set<Key, Hash, KeyEqual, Allocator>::count(const key_type& key) const {
-    return find(key) != cend() ? 1 : 0;
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::load(const std::string& path) {
+    namespace detail = unordered_set_detail;
+    using key_traits = detail::snapshot_key_traits<Key>;
+    static_assert(key_traits::kind != detail::kUnsupportedKeys, "load() needs trivially copyable or std::string keys");
+
+    detail::mapped_file file(path);
+    auto view = detail::snapshot_view<Key>::validate(file.data(), file.size());
+    size_type n = static_cast<size_type>(view.header->element_count);
+    size_type saved_buckets = static_cast<size_type>(view.header->bucket_count);
+
+    size_type samples = std::min(n, detail::kSnapshotHashSamples);
+    for (size_type s = 0; s < samples; ++s) {
+        size_type i = s * n / samples;
+        if (hash_of(key_type(view.key(i))) != view.hashes[i])
+            throw std::runtime_error("unordered_set snapshot was written with a different hasher");
+    }
+
+    unordered_set loaded(saved_buckets, hash_func, key_eq, get_allocator());
+    loaded.max_load_factor_ = view.header->max_load_factor;
+    loaded.min_load_factor_ = min_load_factor_;
+    loaded.reserve_elements(n);
+    for (size_type b = 0; b < saved_buckets; ++b) {
+        size_type first = static_cast<size_type>(view.bucket_starts[b]);
+        size_type last = static_cast<size_type>(view.bucket_starts[b + 1]);
+        // Append each node to its chain, so chains and iteration both follow the file.
+        Node** tail = &loaded.buckets[b];
+        for (size_type i = first; i < last; ++i) {
+            size_type hash = static_cast<size_type>(view.hashes[i]);
+            if ((hash & (saved_buckets - 1)) != b)
+                throw std::runtime_error("invalid unordered_set snapshot: entry in the wrong bucket");
+            Node* node = loaded.create_node(view.key(i));
+            node->store_hash(hash);
+            *tail = node;
+            tail = &node->next;
+            loaded.push_element(node);
+            ++loaded.num_elements;
+        }
+    }
+    *this = std::move(loaded);
 }
 
 /********************************************************************************
  * rehash
  * ------------------------------------------------------------------------------
- * Rehashes the container so that it contains at least new_bucket_count buckets.
+ * Sets the bucket count to new_bucket_count rounded up to a power of two, or
+ * to the smallest power of two that keeps the load factor within
+ * max_load_factor() if that is larger, like std::unordered_set::rehash. The
+ * table may shrink as well as grow. Nodes are relinked into the new buckets
+ * from the element array, using their cached hash codes when available, so
+ * the old bucket array is never read: the cost is O(size() + new bucket
+ * count), and shrinking a sparse table is cheap. This is always done in one
+ * go; a pending incremental rehash is simply abandoned.
  *
  * Parameters:
  *   - new_bucket_count: The desired number of buckets.
@@ -821,31 +2237,39 @@ unordered_set<Key, Hash, KeyEqual, Allocator>::count(const key_type& key) const
  * Returns:
  *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-void unordered_set<Key, Hash, KeyEqual, Allocator>::rehash(size_type new_bucket_count) {
-    if (new_bucket_count <= bucket_count_)
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::rehash(size_type new_bucket_count) {
+    size_type needed = static_cast<size_type>(std::ceil(num_elements / max_load_factor_));
+    new_bucket_count = unordered_set_detail::next_power_of_two(std::max(new_bucket_count, needed));
+    if (new_bucket_count == bucket_count_) {
+        finish_migration();
         return;
-    std::vector<Node*> new_buckets;
-    new_buckets.resize(new_bucket_count, nullptr);
+    }
+    auto timer = this->start_timer();
+    unordered_set_detail::bucket_array<Node*> new_buckets;
+    new_buckets.assign(new_bucket_count, nullptr);
 
-    for (size_type i = 0; i < bucket_count_; ++i) {
-        Node* current = buckets[i];
-        while (current) {
-            Node* next = current->next;
-            size_type new_index = hash_func(current->value) % new_bucket_count;
+    for (size_type i = 0; i < elements.size(); ++i) {
+        if (Node* current = elements[i]) {
+            size_type new_index = node_hash(current) & (new_bucket_count - 1);
             current->next = new_buckets[new_index];
             new_buckets[new_index] = current;
-            current = next;
         }
     }
     buckets.swap(new_buckets);
     bucket_count_ = new_bucket_count;
+    old_buckets.clear();
+    migrated_buckets = 0;
+    this->count_rehash();
+    this->count_allocator_call();
+    this->add_rehash_time(timer);
 }
 
 /********************************************************************************
  * reserve
  * ------------------------------------------------------------------------------
- * Reserves enough buckets to hold at least count / max_load_factor elements.
+ * Reserves enough buckets to hold at least count / max_load_factor elements,
+ * and room for count elements in the element array. Never shrinks.
  *
  * Parameters:
  *   - count: The desired capacity in terms of the number of elements.
@@ -853,9 +2277,173 @@ void unordered_set<Key, Hash, KeyEqual, Allocator>::rehash(size_type new_bucket_
  * Returns:
  *   - None.
  ********************************************************************************/
-template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
-void unordered_set<Key, Hash, KeyEqual, Allocator>::reserve(size_type count) {
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::reserve(size_type count) {
+    if (count > num_elements)
+        reserve_elements(count - num_elements);
     size_type new_bucket_count = static_cast<size_type>(count / max_load_factor_) + 1;
     if (new_bucket_count > bucket_count_)
         rehash(new_bucket_count);
 }
+
+/********************************************************************************
+ * shrink_to_fit
+ * ------------------------------------------------------------------------------
+ * Gives back the memory a once larger set no longer needs: rehashes down to
+ * the smallest bucket count that respects max_load_factor(), and squeezes
+ * the holes and spare capacity out of the element array. Node slabs that
+ * still hold elements cannot be returned, so node memory only drops with
+ * clear() or destruction. Invalidates no iterators.
+ *
+ * Returns:
+ *   - None.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+void unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::shrink_to_fit() {
+    rehash(0);
+    compact_elements();
+    elements.shrink_to_fit();
+}
+
+/********************************************************************************
+ * stats
+ * ------------------------------------------------------------------------------
+ * Walks every bucket once and reports how the elements are spread over them,
+ * together with the memory held by buckets and nodes and, when Traits enables
+ * them, the event counters. During an incremental rehash the chains are
+ * measured as lookups see them, in the new bucket array. node_bytes counts
+ * every slab this set's nodes may live in, including those it shares with
+ * sets it exchanged nodes with through merge() or node handles; each of those
+ * sets reports the same shared total. Takes O(n + buckets) time; meant for
+ * diagnostics, not for hot paths.
+ *
+ * Returns:
+ *   - An unordered_set_stats describing the table.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set_stats unordered_set<Key, Hash, KeyEqual, Allocator, Traits>::stats() const {
+    unordered_set_stats result;
+    result.size = num_elements;
+    result.bucket_count = bucket_count_;
+    result.load_factor = load_factor();
+    result.max_load_factor = max_load_factor_;
+    result.min_load_factor = min_load_factor_;
+
+    size_type probes = 0;
+    for (size_type i = 0; i < bucket_count_; ++i) {
+        size_type length = 0;
+        for (Node* current = bucket_begin(i); current; current = bucket_next(current, i))
+            ++length;
+        if (length >= result.chain_length_histogram.size())
+            result.chain_length_histogram.resize(length + 1, 0);
+        ++result.chain_length_histogram[length];
+        result.longest_chain = std::max(result.longest_chain, length);
+        // Reaching the k-th node of a chain takes k probes.
+        probes += length * (length + 1) / 2;
+    }
+    result.empty_buckets = result.chain_length_histogram.empty() ? 0 : result.chain_length_histogram[0];
+    if (bucket_count_ > 0)
+        result.empty_bucket_ratio = static_cast<double>(result.empty_buckets) / bucket_count_;
+    if (num_elements > 0)
+        result.average_probe_length = static_cast<double>(probes) / num_elements;
+
+    result.bucket_bytes = (buckets.size() + old_buckets.size()) * sizeof(Node*);
+    result.element_bytes = elements.capacity() * sizeof(Node*);
+    result.element_holes = elements.size() - num_elements;
+    result.node_bytes = pool.slab_bytes();
+    result.node_bytes_in_use = num_elements * sizeof(Node);
+    result.rehash_in_progress = migrating();
+    result.counters_enabled = Traits::count_events;
+    result.counters = this->counters();
+    return result;
+}
+
+/********************************************************************************
+ * set_union
+ * ------------------------------------------------------------------------------
+ * Returns a new set holding the elements of both a and b. The larger operand
+ * is copied whole and the other filtered against it, into a result whose
+ * buckets are allocated once for the combined size.
+ *
+ * Parameters:
+ *   - a, b: The operands. They must hash and compare keys the same way; the
+ *     result takes a's hasher, key equality, allocator and max load factor.
+ *   - threads: Number of threads to split each copy pass across.
+ *
+ * Returns:
+ *   - The union.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits> set_union(const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& a, const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& b, unsigned threads) {
+    using set_type = unordered_set<Key, Hash, KeyEqual, Allocator, Traits>;
+    using size_type = typename set_type::size_type;
+
+    const set_type& large = a.size() >= b.size() ? a : b;
+    const set_type& small = a.size() >= b.size() ? b : a;
+    size_type buckets = std::max({ a.bucket_count_, b.bucket_count_,
+                                   static_cast<size_type>((a.size() + b.size()) / a.max_load_factor_) + 1 });
+    set_type result(buckets, a.hash_func, a.key_eq, a.get_allocator());
+    result.max_load_factor_ = a.max_load_factor_;
+    result.copy_matching(large, [](const Key&, size_type) { return true; }, threads);
+    result.copy_matching(small, [&large](const Key& value, size_type hash) {
+        return large.locate(value, hash) == nullptr;
+    }, threads);
+    return result;
+}
+
+/********************************************************************************
+ * set_intersection
+ * ------------------------------------------------------------------------------
+ * Returns a new set holding the elements present in both a and b. Only the
+ * smaller operand is walked; each of its elements is looked up in the other.
+ *
+ * Parameters:
+ *   - a, b: The operands. They must hash and compare keys the same way; the
+ *     result takes a's hasher, key equality, allocator and max load factor.
+ *   - threads: Number of threads to split the walk across.
+ *
+ * Returns:
+ *   - The intersection.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits> set_intersection(const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& a, const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& b, unsigned threads) {
+    using set_type = unordered_set<Key, Hash, KeyEqual, Allocator, Traits>;
+    using size_type = typename set_type::size_type;
+
+    const set_type& large = a.size() >= b.size() ? a : b;
+    const set_type& small = a.size() >= b.size() ? b : a;
+    size_type buckets = std::max(small.bucket_count_, static_cast<size_type>(small.size() / a.max_load_factor_) + 1);
+    set_type result(buckets, a.hash_func, a.key_eq, a.get_allocator());
+    result.max_load_factor_ = a.max_load_factor_;
+    result.copy_matching(small, [&large](const Key& value, size_type hash) {
+        return large.locate(value, hash) != nullptr;
+    }, threads);
+    return result;
+}
+
+/********************************************************************************
+ * set_difference
+ * ------------------------------------------------------------------------------
+ * Returns a new set holding the elements of a that are not in b.
+ *
+ * Parameters:
+ *   - a, b: The operands. They must hash and compare keys the same way; the
+ *     result takes a's hasher, key equality, allocator and max load factor.
+ *   - threads: Number of threads to split the walk over a across.
+ *
+ * Returns:
+ *   - The difference a - b.
+ ********************************************************************************/
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator, typename Traits>
+unordered_set<Key, Hash, KeyEqual, Allocator, Traits> set_difference(const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& a, const unordered_set<Key, Hash, KeyEqual, Allocator, Traits>& b, unsigned threads) {
+    using set_type = unordered_set<Key, Hash, KeyEqual, Allocator, Traits>;
+    using size_type = typename set_type::size_type;
+
+    size_type buckets = std::max(a.bucket_count_, static_cast<size_type>(a.size() / a.max_load_factor_) + 1);
+    set_type result(buckets, a.hash_func, a.key_eq, a.get_allocator());
+    result.max_load_factor_ = a.max_load_factor_;
+    result.copy_matching(a, [&b](const Key& value, size_type hash) {
+        return b.locate(value, hash) == nullptr;
+    }, threads);
+    return result;
+}